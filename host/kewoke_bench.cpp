@@ -0,0 +1,263 @@
+// Micro-benchmark of every front end stage, end to end, of the audio ring and
+// of the broadcast ring, for several MFCC parameterisations. Prints one CSV
+// row per measurement:
+//
+//   config,stage,ns_per_frame,frames_per_sec
+//
+// so runs can be diffed between commits. The FFT type (float, int32 or int16,
+// KEWOKE_FFT_FIXED_POINT) is part of the config name.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "mfcc.h"
+#include "mfcc_constants.hpp"
+#include "ring_buffer.hpp"
+#include "broadcast_ring_buffer.hpp"
+#include "pre_emphasis.hpp"
+#include "frontend.hpp"
+#include "quantization.hpp"
+
+#if !defined(FIXED_POINT)
+static const char* FFT_TYPE = "float";
+#elif FIXED_POINT == 32
+static const char* FFT_TYPE = "int32";
+#else
+static const char* FFT_TYPE = "int16";
+#endif
+
+// Timed loops per measurement, the fastest one is reported (least disturbed)
+constexpr int REPEATS = 5;
+static int iterations = 2000;
+
+static void report(const std::string& config, const char* stage, double ns_per_frame)
+{
+    std::printf("%s,%s,%.1f,%.0f\n", config.c_str(), stage, ns_per_frame, 1e9 / ns_per_frame);
+}
+
+// Fastest mean time of fn() over iterations calls, in ns
+template <typename Fn>
+static double measure_ns(Fn&& fn)
+{
+    double best = INFINITY;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            fn();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ns / iterations);
+    }
+    return best;
+}
+
+// 1 kHz tone over low noise, so no stage sees an all-zero frame
+template <size_t N>
+static std::array<int16_t, N> make_test_signal()
+{
+    std::array<int16_t, N> signal{};
+    uint32_t state = 0x12345678;
+    for (size_t i = 0; i < N; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        int noise = int(state >> 24) - 128;
+        signal[i] = int16_t(8000.0f * sinf(2.0f * float(M_PI) * 1000.0f * i / SAMPLE_RATE) + noise);
+    }
+    return signal;
+}
+
+// Every MFCC stage, the whole MFCC and the audio ring for one parameterisation
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+static void benchmark_mfcc(const char* name)
+{
+    std::string config = std::string(name) + "_" + FFT_TYPE;
+
+    auto mfcc = std::make_unique<MFCC<F, ST, NF, NFFT, NCEPS>>();
+    auto frame = make_test_signal<F>();
+    auto stride = make_test_signal<ST>();
+    PreEmphasis<PRE_EMPHASIS_DC_REMOVAL> pre_emphasis;
+
+    // Stages in pipeline order, each on the output of the previous one
+    report(config, "pre_emphasis", measure_ns([&] { pre_emphasis.process(stride.data(), ST); }));
+    report(config, "window", measure_ns([&] { mfcc->set_signal(frame); }));
+    report(config, "fft", measure_ns([&] { mfcc->compute_FFT(); }));
+    report(config, "power_spectrum", measure_ns([&] { mfcc->compute_power_spectrum(); }));
+    report(config, "mel_banks", measure_ns([&] { mfcc->apply_mel_banks(); }));
+    report(config, "dct", measure_ns([&] { mfcc->compute_DCT(); }));
+    report(config, "mfcc", measure_ns([&] {
+        mfcc->set_signal(frame);
+        mfcc->compute_coefficient();
+    }));
+
+    // Ring: keep one frame minus one stride queued, then write strides until
+    // full and read them back as frames, timing each side separately
+    using Ring = RingBuffer<int16_t, RING_BUFFER_LEN, F, ST>;
+    auto ring = std::make_unique<Ring>();
+    std::array<int16_t, F> read_frame{};
+    ring->write_samples(frame.data(), F - ST);
+    const int strides_per_fill = int((RING_BUFFER_LEN - 1 - (F - ST)) / ST);
+
+    double write_ns = INFINITY;
+    double read_ns = INFINITY;
+    for (int r = 0; r < REPEATS; r++)
+    {
+        std::chrono::steady_clock::duration write_time{};
+        std::chrono::steady_clock::duration read_time{};
+        int fills = std::max(1, iterations / strides_per_fill);
+
+        for (int fill = 0; fill < fills; fill++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int s = 0; s < strides_per_fill; s++)
+                ring->write_samples(stride.data(), ST);
+            auto written = std::chrono::steady_clock::now();
+            for (int s = 0; s < strides_per_fill; s++)
+                ring->read_samples(read_frame.data());
+            read_time += std::chrono::steady_clock::now() - written;
+            write_time += written - start;
+        }
+
+        double frames = double(fills) * strides_per_fill;
+        write_ns = std::min(write_ns, std::chrono::duration<double, std::nano>(write_time).count() / frames);
+        read_ns = std::min(read_ns, std::chrono::duration<double, std::nano>(read_time).count() / frames);
+    }
+
+    RingBufferStats stats = ring->stats();
+    if (stats.overrun_events != 0 || stats.starvation_events != 0)
+    {
+        std::fprintf(stderr, "%s: ring benchmark overran or starved\n", config.c_str());
+        std::exit(1);
+    }
+    report(config, "ring_write_stride", write_ns);
+    report(config, "ring_read_frame", read_ns);
+}
+
+// Quantization and detection around the classifier, and the whole per-frame
+// front end (full and on the silence early exit), with the device parameters
+static void benchmark_device_pipeline()
+{
+    std::string config = std::string("device_") + FFT_TYPE;
+
+    setup_quantization(UNIT_QUANTIZATION);
+
+    auto front_end = std::make_unique<FrontEnd>();
+    auto frame = make_test_signal<FRAME_SIZE>();
+    auto& mfcc = front_end->get_mfcc();
+    mfcc.set_signal(frame);
+    mfcc.compute_coefficient();
+    auto coef = mfcc.get_coefficient();
+
+    FeatureStore::Row quantized{};
+    const int8_t scores[kCategoryCount] = {-128, -100, 90, -128, 20, -120, -128};
+    volatile int detected = 0;
+
+    report(config, "quantize_frame", measure_ns([&] { quantize_frame(coef, quantized); }));
+    report(config, "detect_category", measure_ns([&] { detected = detect_category(scores); }));
+
+    // Frames read in place as from the audio ring, with quantization, feature
+    // store, VAD and inference hop. Loud and quiet frames alternate (18 dB
+    // apart), so the VAD stays active and no frame takes the silence early exit.
+    std::array<std::array<int16_t, FRAME_SIZE>, 2> frames = {frame, frame};
+    for (auto& sample : frames[1])
+        sample = int16_t(sample / 8);
+
+    size_t next = 0;
+    auto process_next = [&] {
+        const auto& samples = frames[next++ % frames.size()];
+        front_end->process_frame({samples.data(), FRAME_SIZE}, {samples.data(), 0});
+    };
+    process_next();
+    uint32_t silent_before = front_end->stats().silent_frames;
+    double full_ns = measure_ns(process_next);
+    if (front_end->stats().silent_frames != silent_before)
+    {
+        std::fprintf(stderr, "%s: front end benchmark took the silence early exit\n", config.c_str());
+        std::exit(1);
+    }
+    report(config, "front_end", full_ns);
+
+    // Steady background: once the noise floor is learnt every frame takes the
+    // early exit (template refreshes off, they would add full frames)
+    auto silent_end = std::make_unique<FrontEnd>();
+    silent_end->get_mfcc().set_silence_refresh(0);
+    RingSpan<const int16_t> first = {frames[1].data(), FRAME_SIZE};
+    RingSpan<const int16_t> second = {frames[1].data(), 0};
+    silent_end->process_frame(first, second);
+    silent_before = silent_end->stats().silent_frames;
+    double silent_ns = measure_ns([&] { silent_end->process_frame(first, second); });
+    if (silent_end->stats().silent_frames - silent_before != uint32_t(REPEATS * iterations))
+    {
+        std::fprintf(stderr, "%s: silent front end benchmark computed full frames\n", config.c_str());
+        std::exit(1);
+    }
+    report(config, "front_end_silent", silent_ns);
+    (void)detected;
+}
+
+// Broadcast ring with three consumers of the same policy, as on the device:
+// one stride written and one frame read by each consumer per iteration
+template <OverrunPolicy POLICY>
+static void benchmark_broadcast_ring(const char* stage)
+{
+    constexpr size_t CONSUMERS = 3;
+    auto ring = std::make_unique<BroadcastRingBuffer<int16_t, RING_BUFFER_LEN, CONSUMERS>>(
+        std::array<OverrunPolicy, CONSUMERS>{POLICY, POLICY, POLICY});
+    auto stride = make_test_signal<FRAME_STRIDE>();
+    std::array<int16_t, FRAME_SIZE> frame{};
+
+    // One frame minus one stride queued for every consumer
+    ring->write_samples(stride.data(), FRAME_STRIDE);
+
+    report(std::string("device_") + FFT_TYPE, stage, measure_ns([&] {
+        ring->write_samples(stride.data(), FRAME_STRIDE);
+        for (size_t c = 0; c < CONSUMERS; c++)
+            ring->read_samples(c, frame.data(), FRAME_SIZE, FRAME_STRIDE);
+    }));
+
+    for (size_t c = 0; c < CONSUMERS; c++)
+    {
+        if (ring->stats(c).dropped_samples != 0)
+        {
+            std::fprintf(stderr, "%s: broadcast ring benchmark dropped samples\n", stage);
+            std::exit(1);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc && std::atoi(argv[i + 1]) > 0)
+        {
+            iterations = std::atoi(argv[++i]);
+        }
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--iterations N]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("config,stage,ns_per_frame,frames_per_sec\n");
+
+    // Device front end: 30 ms frames, 20 ms stride
+    benchmark_mfcc<FRAME_SIZE, FRAME_STRIDE, 40, 512, 40>("nfft512_mel40");
+    benchmark_mfcc<FRAME_SIZE, FRAME_STRIDE, 20, 512, 20>("nfft512_mel20");
+    // 15 ms frames, 10 ms stride
+    benchmark_mfcc<240, 160, 40, 256, 40>("nfft256_mel40");
+    benchmark_mfcc<240, 160, 20, 256, 20>("nfft256_mel20");
+
+    benchmark_device_pipeline();
+    benchmark_broadcast_ring<OverrunPolicy::BLOCK>("broadcast_ring_block");
+    benchmark_broadcast_ring<OverrunPolicy::DROP_OLDEST>("broadcast_ring_drop_oldest");
+    benchmark_broadcast_ring<OverrunPolicy::DROP_SLOW_READER>("broadcast_ring_drop_slow_reader");
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Offline classifier: streams WAV files through the device pipeline (ISR
+// pre-emphasis into the audio ring, MFCC task wakeups, FrontEnd, classifier)
+// and prints the detections and the real-time factor of the processing.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mfcc_constants.hpp"
+#include "audio_ingest.hpp"
+#include "frontend.hpp"
+#include "quantization.hpp"
+#include "wav_file.hpp"
+#ifdef KEWOKE_HOST_TFLM
+#include "audio_recognition.hpp"
+#endif
+
+// Load a 16 kHz mono 16-bit PCM WAV file, prints the reason and returns false otherwise
+static bool load_wav(const char* path, std::vector<int16_t>& samples)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof())
+    {
+        std::fprintf(stderr, "%s: cannot read file\n", path);
+        return false;
+    }
+
+    PcmView pcm;
+    if (const char* error = parse_wav(data.data(), data.size(), pcm))
+    {
+        std::fprintf(stderr, "%s: %s\n", path, error);
+        return false;
+    }
+
+    samples.assign(pcm.samples, pcm.samples + pcm.count);
+    return true;
+}
+
+struct FileResult
+{
+    size_t frames = 0;
+    size_t windows = 0;
+    size_t detections = 0;
+    size_t wakeups = 0;
+    size_t empty_wakeups = 0;
+    double processing_s = 0.0;
+};
+
+// Feed the samples in I2S DMA sized blocks through the same ingest as the
+// ISR. A block that completes frames wakes the MFCC task on the device, here
+// it drains the ring the same way.
+static FileResult classify(const char* path, const std::vector<int16_t>& samples)
+{
+    auto ingest = std::make_unique<AudioIngest>();
+    auto front_end = std::make_unique<FrontEnd>();
+    FeatureWindow window;
+    FileResult result;
+
+    RingSpan<const int16_t> first;
+    RingSpan<const int16_t> second;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t offset = 0; offset < samples.size(); offset += I2S_DMA_FRAME_SAMPLES)
+    {
+        size_t block = std::min<size_t>(I2S_DMA_FRAME_SAMPLES, samples.size() - offset);
+        if (ingest->write(&samples[offset], block) == 0)
+            continue;
+
+        result.wakeups++;
+        if (!ingest->peek(first, second))
+            result.empty_wakeups++;
+
+        while (ingest->peek(first, second))
+        {
+            bool window_ready = front_end->process_frame(first, second);
+            ingest->consume(FRAME_STRIDE);
+            result.frames++;
+
+            if (!window_ready)
+                continue;
+
+            front_end->copy_window(window);
+            result.windows++;
+#ifdef KEWOKE_HOST_TFLM
+            int detected = run_inference(window);
+            if (detected >= 0)
+            {
+                // Time of the end of the window
+                double end_s = double((result.frames - 1) * FRAME_STRIDE + FRAME_SIZE) / SAMPLE_RATE;
+                std::printf("%s: %7.2f s  %s\n", path, end_s, kCategoryLabels[detected]);
+                result.detections++;
+            }
+#endif
+        }
+    }
+
+    result.processing_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    FrontEndStats stats = front_end->stats();
+    RingBufferStats ring = ingest->get_ring().stats();
+    double audio_s = double(samples.size()) / SAMPLE_RATE;
+    std::printf("%s: %.2f s audio, %zu frames (%u silent), %zu windows to classify, %u skipped by VAD, "
+                "%zu detections, %.3f s processing, real-time factor %.4f\n",
+                path, audio_s, result.frames, stats.silent_frames, result.windows, stats.skipped_windows,
+                result.detections, result.processing_s, audio_s > 0 ? result.processing_s / audio_s : 0.0);
+    std::printf("%s: %zu wakeups (%zu without a frame), %u ring overruns, %u starvation events\n",
+                path, result.wakeups, result.empty_wakeups, ring.overrun_events, ring.starvation_events);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "usage: %s file.wav [file.wav ...]\n", argv[0]);
+        return 2;
+    }
+
+#ifdef KEWOKE_HOST_TFLM
+    setup_recognition();
+#else
+    // No classifier in this build: windows are counted but not classified
+    setup_quantization(UNIT_QUANTIZATION);
+#endif
+
+    int status = 0;
+    double total_audio_s = 0.0;
+    double total_processing_s = 0.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::vector<int16_t> samples;
+        if (!load_wav(argv[i], samples))
+        {
+            status = 1;
+            continue;
+        }
+
+        FileResult result = classify(argv[i], samples);
+        total_audio_s += double(samples.size()) / SAMPLE_RATE;
+        total_processing_s += result.processing_s;
+    }
+
+    if (argc > 2 && total_audio_s > 0)
+    {
+        std::printf("total: %.2f s audio, %.3f s processing, real-time factor %.4f\n",
+                    total_audio_s, total_processing_s, total_processing_s / total_audio_s);
+    }
+
+    return status;
+}
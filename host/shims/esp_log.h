@@ -0,0 +1,13 @@
+#pragma once
+// Host shim: ESP-IDF log macros printed to stderr
+
+#include <cstdio>
+
+#define KEWOKE_HOST_LOG(level, tag, format, ...) \
+    std::fprintf(stderr, level " (%s) " format "\n", tag, ##__VA_ARGS__)
+
+#define ESP_LOGE(tag, format, ...) KEWOKE_HOST_LOG("E", tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) KEWOKE_HOST_LOG("W", tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) KEWOKE_HOST_LOG("I", tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#define ESP_LOGV(tag, format, ...) do { } while (0)
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+
+// Minimal assertions for the host tests: each failure is printed and counted,
+// main() returns test_result() so ctest sees a nonzero status
+inline int check_failures = 0;
+
+#define CHECK(condition, ...)                                                   \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #condition); \
+            std::fprintf(stderr, __VA_ARGS__);                                  \
+            std::fputc('\n', stderr);                                           \
+            check_failures++;                                                   \
+        }                                                                       \
+    } while (0)
+
+inline int test_result(const char* name)
+{
+    if (check_failures == 0)
+        std::printf("%s: passed\n", name);
+    else
+        std::printf("%s: %d checks failed\n", name, check_failures);
+    return check_failures == 0 ? 0 : 1;
+}
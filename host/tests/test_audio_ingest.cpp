@@ -0,0 +1,122 @@
+// AudioIngest frame accounting, driven as on the device: the source writes
+// blocks, every block that reports completed frames wakes the consumer, which
+// drains the ring. Checks that
+//   - a consumer that keeps up never wakes up to an empty ring, never starves
+//     and sees every frame, whatever the block size,
+//   - after overruns, the frames reported still match the frames readable
+//     (no notification for a sample the ring refused).
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "audio_ingest.hpp"
+#include "check.hpp"
+
+struct Replay
+{
+    uint32_t reported = 0; // Frames write() reported, one notification each on the device
+    uint32_t wakeups = 0;
+    uint32_t empty_wakeups = 0;
+    uint32_t frames = 0;
+};
+
+// Drain every complete frame, as the MFCC task does after a wakeup
+static uint32_t drain(AudioIngest& ingest)
+{
+    RingSpan<const int16_t> first;
+    RingSpan<const int16_t> second;
+    uint32_t frames = 0;
+    while (ingest.peek(first, second))
+    {
+        ingest.consume(FRAME_STRIDE);
+        frames++;
+    }
+    return frames;
+}
+
+// Write samples in blocks of block_size, the consumer only wakes up when a
+// block completes frames and skips the wakeups in [stall_from, stall_to)
+static Replay replay(AudioIngest& ingest, const std::vector<int16_t>& samples, size_t block_size,
+                     uint32_t stall_from = 0, uint32_t stall_to = 0)
+{
+    Replay result;
+    uint32_t block_index = 0;
+    uint32_t pending = 0;
+
+    for (size_t offset = 0; offset < samples.size(); offset += block_size, block_index++)
+    {
+        size_t count = std::min(block_size, samples.size() - offset);
+        uint32_t completed = ingest.write(&samples[offset], count);
+        result.reported += completed;
+        pending += completed;
+
+        if (pending == 0 || (block_index >= stall_from && block_index < stall_to))
+            continue;
+
+        // Notifications are counted but taken all at once
+        pending = 0;
+        result.wakeups++;
+        uint32_t frames = drain(ingest);
+        if (frames == 0)
+            result.empty_wakeups++;
+        result.frames += frames;
+    }
+    return result;
+}
+
+static std::vector<int16_t> test_signal(size_t count)
+{
+    std::vector<int16_t> samples(count);
+    uint32_t state = 0x9e3779b9;
+    for (auto& sample : samples)
+    {
+        state = state * 1664525u + 1013904223u;
+        sample = int16_t(state >> 20);
+    }
+    return samples;
+}
+
+int main()
+{
+    // 10 s of audio
+    const auto samples = test_signal(10 * SAMPLE_RATE);
+    const uint32_t stream_frames = (samples.size() - FRAME_SIZE) / FRAME_STRIDE + 1;
+
+    for (size_t block_size : {size_t(I2S_DMA_FRAME_SAMPLES), size_t(160), size_t(FRAME_STRIDE), size_t(1000)})
+    {
+        auto ingest = std::make_unique<AudioIngest>();
+        Replay result = replay(*ingest, samples, block_size);
+        RingBufferStats stats = ingest->get_ring().stats();
+        std::printf("%zu-sample blocks: %u frames, %u wakeups, %u empty, %u starvation events\n",
+                    block_size, result.frames, result.wakeups, result.empty_wakeups, stats.starvation_events);
+
+        CHECK(result.frames == stream_frames, "%zu-sample blocks: %u of %u frames", block_size, result.frames, stream_frames);
+        CHECK(result.reported == stream_frames, "%zu-sample blocks: %u frames reported", block_size, result.reported);
+        CHECK(result.empty_wakeups == 0, "%zu-sample blocks: %u empty wakeups", block_size, result.empty_wakeups);
+        CHECK(stats.starvation_events == 0, "%zu-sample blocks: %u starvation events", block_size, stats.starvation_events);
+        CHECK(stats.overrun_events == 0, "%zu-sample blocks: %u overruns", block_size, stats.overrun_events);
+    }
+
+    // Consumer stalled for 50 DMA blocks (0.75 s): the ring overruns, then
+    // the consumer catches up. Every reported frame must be readable, every
+    // readable frame reported.
+    {
+        auto ingest = std::make_unique<AudioIngest>();
+        Replay result = replay(*ingest, samples, I2S_DMA_FRAME_SAMPLES, 100, 150);
+        RingBufferStats stats = ingest->get_ring().stats();
+        uint32_t committed = uint32_t(samples.size()) - stats.dropped_samples;
+        uint32_t readable_frames = (committed - FRAME_SIZE) / FRAME_STRIDE + 1;
+        std::printf("stalled consumer: %u frames, %u reported, %u overruns, %u wakeups, %u empty\n",
+                    result.frames, result.reported, stats.overrun_events, result.wakeups, result.empty_wakeups);
+
+        CHECK(stats.overrun_events > 0, "stalled consumer never overran the ring");
+        CHECK(result.reported == readable_frames, "%u frames reported, %u readable", result.reported, readable_frames);
+        CHECK(result.frames == readable_frames, "%u frames read, %u readable", result.frames, readable_frames);
+        CHECK(result.empty_wakeups == 0, "%u empty wakeups after the overruns", result.empty_wakeups);
+    }
+
+    return test_result("test_audio_ingest");
+}
@@ -0,0 +1,231 @@
+// BroadcastRingBuffer with a producer thread and three consumer threads of
+// different speeds, under each overrun policy and with the three policies
+// mixed. Every sample holds its stream position, so each consumer checks that
+//   - every frame it reads is contiguous (no torn copy the writer raced with),
+//   - frames follow each other by one stride, except after a drop,
+//   - the samples it skipped add up to its dropped_samples counter,
+//   - BLOCK consumers never skip anything and read every frame.
+// The last consumer is parked until the producer has written past the ring
+// capacity (or, if it blocks, until the producer is refused), so its overrun
+// does not depend on thread timing and its drop counts are checked exactly.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "broadcast_ring_buffer.hpp"
+#include "mfcc_constants.hpp"
+#include "check.hpp"
+
+constexpr size_t CONSUMERS = 3;
+constexpr uint32_t STREAM_SAMPLES = 1000 * I2S_DMA_FRAME_SAMPLES;
+constexpr uint32_t STREAM_FRAMES = (STREAM_SAMPLES - FRAME_SIZE) / FRAME_STRIDE + 1;
+
+// The producer writes one block, then sleeps BLOCK_PERIOD_US (at most 150
+// times real time). Per-frame work of each consumer: none, about one block
+// period, and ten times that (drops on every lap unless it blocks)
+constexpr int BLOCK_PERIOD_US = 100;
+constexpr std::array<int, CONSUMERS> CONSUMER_WORK_US = {0, 100, 1000};
+
+// Written before the parked consumer reads anything: PARK_OVERRUN_BLOCKS
+// blocks more than the ring holds
+constexpr size_t PARKED = CONSUMERS - 1;
+constexpr uint32_t PARK_OVERRUN_BLOCKS = 4;
+constexpr uint32_t PARK_SAMPLES = (RING_BUFFER_LEN / I2S_DMA_FRAME_SAMPLES + PARK_OVERRUN_BLOCKS) * I2S_DMA_FRAME_SAMPLES;
+static_assert(RING_BUFFER_LEN % I2S_DMA_FRAME_SAMPLES != 0, "PARK_OVERRUN_BLOCKS assumes a partial last block");
+static_assert(PARK_SAMPLES < STREAM_SAMPLES, "The stream must outlast the parked phase");
+
+using Ring = BroadcastRingBuffer<uint32_t, RING_BUFFER_LEN, CONSUMERS>;
+
+// Handshake with the parked consumer: the producer releases it, then waits
+// for its first read attempt before writing on
+struct Park
+{
+    std::atomic<bool> released{false};
+    std::atomic<bool> attempted{false};
+};
+
+struct ConsumerResult
+{
+    uint32_t frames = 0;
+    uint32_t skipped = 0;
+    uint32_t torn = 0;
+    uint32_t backwards = 0;
+};
+
+static void busy_wait_us(int us)
+{
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while (std::chrono::steady_clock::now() < until) {}
+}
+
+static void consume(Ring& ring, size_t index, const std::atomic<bool>& done, Park& park, ConsumerResult& result)
+{
+    std::array<uint32_t, FRAME_SIZE> frame;
+    uint32_t expected = 0;
+
+    if (index == PARKED)
+    {
+        while (!park.released.load(std::memory_order_acquire))
+            std::this_thread::yield();
+    }
+
+    while (true)
+    {
+        // Read the done flag first: once set, a failed read means the stream is drained
+        bool finished = done.load(std::memory_order_acquire);
+        bool read = ring.read_samples(index, frame.data(), FRAME_SIZE, FRAME_STRIDE);
+        if (index == PARKED)
+            park.attempted.store(true, std::memory_order_release);
+        if (!read)
+        {
+            if (finished)
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+
+        for (size_t i = 1; i < FRAME_SIZE; i++)
+        {
+            if (frame[i] != frame[0] + i)
+            {
+                result.torn++;
+                break;
+            }
+        }
+
+        if (frame[0] < expected)
+            result.backwards++;
+        else
+            result.skipped += frame[0] - expected;
+        expected = frame[0] + FRAME_STRIDE;
+        result.frames++;
+
+        busy_wait_us(CONSUMER_WORK_US[index]);
+    }
+
+    // A drop after the last frame read moved the cursor past it
+    uint32_t cursor = STREAM_SAMPLES - uint32_t(ring.available(index));
+    if (cursor < expected)
+        result.backwards++;
+    else
+        result.skipped += cursor - expected;
+}
+
+static void run(const char* name, const std::array<OverrunPolicy, CONSUMERS>& policies)
+{
+    auto ring = std::make_unique<Ring>(policies);
+    std::atomic<bool> done{false};
+    Park park;
+    std::array<ConsumerResult, CONSUMERS> results;
+
+    std::vector<std::thread> consumers;
+    for (size_t c = 0; c < CONSUMERS; c++)
+        consumers.emplace_back(consume, std::ref(*ring), c, std::cref(done), std::ref(park), std::ref(results[c]));
+
+    // Parked consumer's counters after its first read attempt, the producer paused
+    BroadcastConsumerStats parked_stats{};
+    uint32_t parked_written = 0;
+    auto release_parked = [&](uint32_t written) {
+        if (park.released.load(std::memory_order_relaxed))
+            return;
+        park.released.store(true, std::memory_order_release);
+        while (!park.attempted.load(std::memory_order_acquire))
+            std::this_thread::yield();
+        parked_stats = ring->stats(PARKED);
+        parked_written = written;
+    };
+
+    // I2S DMA sized blocks, retried while a BLOCK consumer has no room
+    std::array<uint32_t, I2S_DMA_FRAME_SAMPLES> block;
+    for (uint32_t position = 0; position < STREAM_SAMPLES; position += I2S_DMA_FRAME_SAMPLES)
+    {
+        for (size_t i = 0; i < block.size(); i++)
+            block[i] = position + i;
+        while (!ring->write_samples(block.data(), block.size()))
+        {
+            // A parked BLOCK consumer holds the writer back until released
+            if (policies[PARKED] == OverrunPolicy::BLOCK)
+                release_parked(position);
+            std::this_thread::yield();
+        }
+        if (position + block.size() == PARK_SAMPLES)
+            release_parked(PARK_SAMPLES);
+        std::this_thread::sleep_for(std::chrono::microseconds(BLOCK_PERIOD_US));
+    }
+    done.store(true, std::memory_order_release);
+
+    for (auto& consumer : consumers)
+        consumer.join();
+
+    for (size_t c = 0; c < CONSUMERS; c++)
+    {
+        const ConsumerResult& result = results[c];
+        BroadcastConsumerStats stats = ring->stats(c);
+        std::printf("%s consumer %zu: %u frames, %u samples skipped, %u dropped in %u overruns\n",
+                    name, c, result.frames, result.skipped, stats.dropped_samples, stats.overrun_events);
+
+        CHECK(result.torn == 0, "%s consumer %zu: %u torn frames", name, c, result.torn);
+        CHECK(result.backwards == 0, "%s consumer %zu: %u frames went backwards", name, c, result.backwards);
+        CHECK(result.skipped == stats.dropped_samples, "%s consumer %zu: skipped %u samples, counted %u dropped",
+              name, c, result.skipped, stats.dropped_samples);
+        CHECK((stats.overrun_events == 0) == (stats.dropped_samples == 0), "%s consumer %zu: %u overruns, %u dropped",
+              name, c, stats.overrun_events, stats.dropped_samples);
+
+        if (policies[c] == OverrunPolicy::BLOCK)
+        {
+            CHECK(stats.dropped_samples == 0, "%s consumer %zu: BLOCK consumer dropped %u samples",
+                  name, c, stats.dropped_samples);
+            CHECK(result.frames == STREAM_FRAMES, "%s consumer %zu: %u of %u frames",
+                  name, c, result.frames, STREAM_FRAMES);
+        }
+    }
+
+    bool blocking = false;
+    for (OverrunPolicy policy : policies)
+        blocking = blocking || policy == OverrunPolicy::BLOCK;
+    if (!blocking)
+        CHECK(ring->get_blocked_writes() == 0, "%s: %u writes blocked without a BLOCK consumer",
+              name, ring->get_blocked_writes());
+
+    // Parked consumer at its first read: DROP_OLDEST kept the newest ring
+    // full (one overrun per block past capacity), DROP_SLOW_READER skipped
+    // everything written (one overrun), BLOCK refused the writer instead
+    switch (policies[PARKED])
+    {
+    case OverrunPolicy::BLOCK:
+        CHECK(parked_written == RING_BUFFER_LEN / I2S_DMA_FRAME_SAMPLES * I2S_DMA_FRAME_SAMPLES,
+              "%s: parked consumer released after %u samples", name, parked_written);
+        CHECK(parked_stats.dropped_samples == 0, "%s: parked BLOCK consumer dropped %u samples",
+              name, parked_stats.dropped_samples);
+        CHECK(ring->get_blocked_writes() > 0, "%s: parked BLOCK consumer never blocked the writer", name);
+        break;
+    case OverrunPolicy::DROP_OLDEST:
+        CHECK(parked_stats.dropped_samples == PARK_SAMPLES - RING_BUFFER_LEN &&
+              parked_stats.overrun_events == PARK_OVERRUN_BLOCKS,
+              "%s: parked consumer dropped %u samples in %u overruns, expected %u in %u", name,
+              parked_stats.dropped_samples, parked_stats.overrun_events, PARK_SAMPLES - RING_BUFFER_LEN,
+              PARK_OVERRUN_BLOCKS);
+        break;
+    case OverrunPolicy::DROP_SLOW_READER:
+        CHECK(parked_stats.dropped_samples == PARK_SAMPLES && parked_stats.overrun_events == 1,
+              "%s: parked consumer dropped %u samples in %u overruns, expected %u in 1", name,
+              parked_stats.dropped_samples, parked_stats.overrun_events, PARK_SAMPLES);
+        break;
+    }
+}
+
+int main()
+{
+    run("block", {OverrunPolicy::BLOCK, OverrunPolicy::BLOCK, OverrunPolicy::BLOCK});
+    run("drop_oldest", {OverrunPolicy::DROP_OLDEST, OverrunPolicy::DROP_OLDEST, OverrunPolicy::DROP_OLDEST});
+    run("drop_slow_reader",
+        {OverrunPolicy::DROP_SLOW_READER, OverrunPolicy::DROP_SLOW_READER, OverrunPolicy::DROP_SLOW_READER});
+    run("mixed", {OverrunPolicy::BLOCK, OverrunPolicy::DROP_OLDEST, OverrunPolicy::DROP_SLOW_READER});
+    return test_result("test_broadcast_ring");
+}
@@ -0,0 +1,62 @@
+// FixedLog against the double precision natural log, over Q30 inputs from the
+// mel log floor to the top of the 64-bit range: every octave, 4096 mantissas
+// per octave plus the octave edges. Checks the error bounds quoted in mfcc.h.
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "mfcc.h"
+#include "check.hpp"
+
+// Largest |log_q8<30>(x) - 256 ln(x / 2^30)| over the sweep, in Q8 LSB
+template <int BITS, bool INTERPOLATE>
+static double max_error_q8()
+{
+    double max_error = 0;
+    uint64_t worst = 0;
+
+    auto check = [&](uint64_t x) {
+        if (x < uint64_t(MEL_LOG_FLOOR_Q30))
+            return;
+        double expected = 256.0 * (std::log(double(x)) - 30.0 * std::log(2.0));
+        double error = std::fabs(FixedLog<BITS, INTERPOLATE>::template log_q8<30>(x) - expected);
+        if (error > max_error)
+        {
+            max_error = error;
+            worst = x;
+        }
+    };
+
+    for (int exponent = 0; exponent < 64; exponent++)
+    {
+        uint64_t octave = uint64_t(1) << exponent;
+        for (uint64_t step = 0; step < 4096; step++)
+            check(octave + uint64_t(std::ldexp(double(step), exponent - 12)));
+        check(octave - 1);
+        check(octave + 1);
+    }
+    check(UINT64_MAX);
+
+    std::printf("FixedLog<%d, %s>: max error %.3f Q8 LSB (at %llu)\n", BITS, INTERPOLATE ? "interpolated" : "nearest",
+                max_error, (unsigned long long)worst);
+    return max_error;
+}
+
+int main()
+{
+    double mel_error = max_error_q8<MEL_LOG_LUT_BITS, MEL_LOG_INTERPOLATE>();
+    CHECK(mel_error <= 0.54, "mel log error %.3f LSB", mel_error);
+
+    // Table sizes quoted against the interpolated one
+    double error_6 = max_error_q8<6, false>();
+    CHECK(error_6 <= 2.5, "6-bit table error %.3f LSB", error_6);
+    double error_8 = max_error_q8<8, false>();
+    CHECK(error_8 <= 1.0, "8-bit table error %.3f LSB", error_8);
+
+    // The floor itself: MEL_LOG_FLOOR_Q8 is ln(1e-7) and the Q30 floor its rounded up input
+    CHECK(std::fabs(MEL_LOG_FLOOR_Q8 - 256.0 * std::log(1e-7)) <= 0.5, "MEL_LOG_FLOOR_Q8 %d", MEL_LOG_FLOOR_Q8);
+    CHECK(MEL_LOG_FLOOR_Q30 == int32_t(std::ceil(1e-7 * (1 << 30))), "MEL_LOG_FLOOR_Q30 %d", MEL_LOG_FLOOR_Q30);
+
+    return test_result("test_fixed_log");
+}
@@ -0,0 +1,124 @@
+// MFCC::apply_mel_banks() reads packed nonzero filter spans. Checks it against
+// a dense filter bank (every filter weighted over every FFT bin) built from the
+// same triangle definition: both must give bit-identical filter banks and frame
+// energy for every signal and parameterisation.
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "mfcc.h"
+#include "check.hpp"
+
+// Dense reference: NF rows of NFFT/2 + 1 Q15 weights, zeros included
+template <int NF, int NFFT>
+static std::vector<std::array<int16_t, NFFT / 2 + 1>> dense_filters()
+{
+    auto to_hz = [](float m) { return 700.f * (powf(10.f, m / 2595.f) - 1.f); };
+    const float max_mel = 2595 * log10f(1 + (SAMPLE_FREQ / 2) / 700.0f);
+    const float delta = max_mel / (NF + 1);
+
+    std::vector<std::array<int16_t, NFFT / 2 + 1>> filters(NF);
+    for (int f = 0; f < NF; f++)
+    {
+        float f_min = to_hz(delta * f);
+        float f_center = to_hz(delta * (f + 1));
+        float f_max = to_hz(delta * (f + 2));
+
+        for (int bin = 0; bin < NFFT / 2 + 1; bin++)
+        {
+            float freq_hz = bin * (float(SAMPLE_FREQ) / NFFT);
+            float w = 0;
+            if (freq_hz >= f_min && freq_hz < f_center)
+                w = (freq_hz - f_min) / (f_center - f_min);
+            else if (freq_hz >= f_center && freq_hz < f_max)
+                w = (f_max - freq_hz) / (f_max - f_center);
+            filters[f][bin] = int16_t(w * 32767.f);
+        }
+    }
+    return filters;
+}
+
+static int16_t reference_log_q8(uint64_t energy)
+{
+    if (energy < uint64_t(MEL_LOG_FLOOR_Q30))
+        return MEL_LOG_FLOOR_Q8;
+    int32_t q = MFCC<>::MelLog::log_q8<30>(energy);
+    return int16_t(std::clamp(q, int32_t(-32768), int32_t(32767)));
+}
+
+// Test frames: silence, a quiet tone near the log floor, tones, a chirp over
+// the whole band, white noise and a full scale square wave
+template <int F>
+static std::vector<std::array<int16_t, F>> test_frames()
+{
+    std::vector<std::array<int16_t, F>> frames;
+    uint32_t state = 0x2545f491;
+    for (int kind = 0; kind < 7; kind++)
+    {
+        std::array<int16_t, F> frame{};
+        for (int i = 0; i < F; i++)
+        {
+            float t = float(i) / SAMPLE_FREQ;
+            state = state * 1664525u + 1013904223u;
+            float value = 0;
+            switch (kind)
+            {
+            case 0: value = 0; break;
+            case 1: value = 2.0f * sinf(2.0f * float(M_PI) * 440.0f * t); break;
+            case 2: value = 8000.0f * sinf(2.0f * float(M_PI) * 1000.0f * t); break;
+            case 3: value = 12000.0f * sinf(2.0f * float(M_PI) * 7900.0f * t); break;
+            case 4: value = 10000.0f * sinf(2.0f * float(M_PI) * (100.0f + 250000.0f * t) * t); break;
+            case 5: value = float(int32_t(state) >> 16); break;
+            case 6: value = (i / 8) % 2 ? 32767.0f : -32768.0f; break;
+            }
+            frame[i] = int16_t(value);
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+static void check_config(const char* name)
+{
+    auto mfcc = std::make_unique<MFCC<F, ST, NF, NFFT, NCEPS>>();
+    const auto filters = dense_filters<NF, NFFT>();
+    const auto frames = test_frames<F>();
+
+    for (size_t n = 0; n < frames.size(); n++)
+    {
+        mfcc->set_signal(frames[n]);
+        mfcc->compute_coefficient();
+
+        const auto& power = mfcc->get_power_spectrum();
+        const auto& banks = mfcc->get_filter_banks();
+        uint64_t total = 0;
+
+        for (int f = 0; f < NF; f++)
+        {
+            int64_t acc = 0;
+            for (int bin = 0; bin < NFFT / 2 + 1; bin++)
+                acc += int64_t(power[bin]) * filters[f][bin];
+            total += uint64_t(acc);
+
+            int16_t expected = reference_log_q8(uint64_t(acc));
+            CHECK(banks[f] == expected, "%s frame %zu filter %d: %d, dense %d", name, n, f, banks[f], expected);
+        }
+
+        int16_t expected_energy = reference_log_q8(total);
+        CHECK(mfcc->get_frame_energy() == expected_energy, "%s frame %zu energy: %d, dense %d",
+              name, n, mfcc->get_frame_energy(), expected_energy);
+    }
+}
+
+int main()
+{
+    check_config<480, 320, 40, 512, 40>("nfft512_mel40");
+    check_config<480, 320, 20, 512, 20>("nfft512_mel20");
+    check_config<240, 160, 40, 256, 40>("nfft256_mel40");
+    check_config<400, 160, 64, 512, 13>("nfft512_mel64");
+    return test_result("test_mel_banks");
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#ifdef KEWOKE_LATENCY_TRACE
+#include "esp_timer.h"
+#endif
+
+#include "mfcc_constants.hpp"
+#include "ring_buffer.hpp"
+#include "pre_emphasis.hpp"
+#include "stage_profiler.hpp"
+
+#ifdef KEWOKE_LATENCY_TRACE
+// Completion times kept, frame k's slot is reused by frame k + FRAME_TIMESTAMP_COUNT.
+// That frame cannot complete while frame k is still in the ring, so the reader
+// always finds the time of the frame it is processing.
+constexpr size_t FRAME_TIMESTAMP_COUNT = 8;
+static_assert(FRAME_SIZE + FRAME_TIMESTAMP_COUNT * FRAME_STRIDE > RING_BUFFER_LEN - 1,
+              "Frame timestamps would be overwritten while their frame is still in the ring");
+#endif
+
+// Audio ring with its ingest side: pre-emphasis of each block into the ring
+// and the count of frames each block completes. No RTOS dependency, the
+// device wraps it in AudioSink (notifications) and the host tools use it as is.
+class AudioIngest
+{
+public:
+    using Ring = RingBuffer<int16_t, RING_BUFFER_LEN, FRAME_SIZE, FRAME_STRIDE>;
+
+    // Filter count samples into the ring, returns the frames completed
+    uint32_t write(const int16_t* samples, size_t count)
+    {
+        RingSpan<int16_t> first;
+        RingSpan<int16_t> second;
+        if (!ring.reserve_write(count, first, second))
+        {
+            return 0; // Overrun: the block never reaches the reader, it completes nothing
+        }
+
+        {
+            KEWOKE_PROFILE_SCOPE(ProfileStage::PRE_EMPHASIS);
+            pre_emphasis.process(samples, first.data, first.size);
+            pre_emphasis.process(samples + first.size, second.data, second.size);
+        }
+
+        // Frame k is complete once FRAME_SIZE + k * FRAME_STRIDE samples are in
+        // the ring. A block may complete several frames, or none.
+        committed_samples += count;
+        uint32_t frames = 0;
+        while (int32_t(committed_samples - next_frame_end) >= 0)
+        {
+            next_frame_end += FRAME_STRIDE;
+            frames++;
+        }
+
+#ifdef KEWOKE_LATENCY_TRACE
+        // Before the commit, which publishes them to the reader with the samples
+        uint32_t now_us = uint32_t(esp_timer_get_time());
+        for (uint32_t i = 0; i < frames; i++)
+            frame_ready_us[completed_frames++ % FRAME_TIMESTAMP_COUNT] = now_us;
+#endif
+
+        ring.commit_write(count);
+        return frames;
+    }
+
+    // Reader side, see RingBuffer::peek()
+    bool peek(RingSpan<const int16_t>& first, RingSpan<const int16_t>& second) { return ring.peek(first, second); }
+    void consume(size_t size) { ring.consume(size); }
+
+    size_t free_space() { return ring.free_space(); }
+    Ring& get_ring() { return ring; }
+
+#ifdef KEWOKE_LATENCY_TRACE
+    // esp_timer time (µs, truncated) at which frame number frame (counted from
+    // the start of the stream, in read order) was completed by a write()
+    uint32_t frame_ready_time_us(uint32_t frame) const { return frame_ready_us[frame % FRAME_TIMESTAMP_COUNT]; }
+#endif
+
+private:
+    Ring ring;
+
+    // Pre-emphasis state follows the stream, not the MFCC frames
+    PreEmphasis<PRE_EMPHASIS_DC_REMOVAL> pre_emphasis;
+
+    // Samples committed since start and the count that completes the next frame
+    // (free running, compared through their difference)
+    uint32_t committed_samples = 0;
+    uint32_t next_frame_end = FRAME_SIZE;
+
+#ifdef KEWOKE_LATENCY_TRACE
+    uint32_t frame_ready_us[FRAME_TIMESTAMP_COUNT] = {};
+    uint32_t completed_frames = 0;
+#endif
+};
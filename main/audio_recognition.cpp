@@ -1,5 +1,20 @@
+#include <cmath>
+#include <cstring>
 #include "esp_log.h"
+
+// tfmicro
+#include "tensorflow/lite/micro/system_setup.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/micro/micro_interpreter.h"
+#include "tensorflow/lite/micro/micro_log.h"
+#include "tensorflow/lite/micro/micro_mutable_op_resolver.h"
+
+// Models
+#include "model_classifier.h"
+
 #include "audio_recognition.hpp"
+#include "stage_profiler.hpp"
 
 static const char* TAG = "audio_recognition";
 
@@ -8,11 +23,11 @@ constexpr int CLASSIFIER_ARENA_SIZE = 51 * 1024;
 static tflite::MicroMutableOpResolver<8> shared_resolver;
 alignas(16) static uint8_t classifier_arena[CLASSIFIER_ARENA_SIZE];
 
-const tflite::Model* model_classifier = nullptr;
+static const tflite::Model* model_classifier = nullptr;
 
-tflite::MicroInterpreter* classifier = nullptr;
+static tflite::MicroInterpreter* classifier = nullptr;
 
-void load_model(const tflite::Model*& model, const void* source_model)
+static void load_model(const tflite::Model*& model, const void* source_model)
 {
     model = tflite::GetModel(source_model);
     if (model->version() != TFLITE_SCHEMA_VERSION) {
@@ -23,7 +38,7 @@ void load_model(const tflite::Model*& model, const void* source_model)
 }
 
 // Setup function (call once at startup)
-void setup_models() {
+static void setup_models() {
     // Register ops once
     shared_resolver.AddConv2D();          // CONV_2D
     shared_resolver.AddFullyConnected();  // FULLY_CONNECTED
@@ -36,7 +51,7 @@ void setup_models() {
 }
 
 // Create interpreters as static (once)
-void setup_interpreters()
+static void setup_interpreters()
 {    
     static tflite::MicroInterpreter classifier_interpreter(
         model_classifier, shared_resolver, classifier_arena, CLASSIFIER_ARENA_SIZE);
@@ -48,6 +63,10 @@ void setup_interpreters()
         ESP_LOGI(TAG,"AllocateTensors() failed");
         return;
     }
+
+    const TfLiteQuantizationParams& input = classifier->input(0)->params;
+    const TfLiteQuantizationParams& output = classifier->output(0)->params;
+    setup_quantization({input.scale, input.zero_point, output.scale, output.zero_point});
 }
 
 void setup_recognition()
@@ -57,50 +76,29 @@ void setup_recognition()
     setup_interpreters();
 }
 
-void run_inference(std::array<std::array<int16_t, NUMBER_CEPS>, NUM_FRAMES> coefficient)
+int run_inference(const FeatureWindow& window)
 {
-    TfLiteTensor* input = classifier->input(0);
-    float input_scale = input->params.scale;
-    int input_zero_point = input->params.zero_point;
-    int8_t* input_ptr = input->data.int8;
-
-    // Flatten and quantize directly into the input tensor
-    for (size_t i = 0; i < NUM_FRAMES; i++) {
-        for (size_t j = 0; j < NUMBER_CEPS; j++) {
-            float mfcc_float = static_cast<float>(coefficient[i][j]);
-
-            // Quantize to int8 and clamp
-            int32_t q = static_cast<int32_t>(std::round(mfcc_float / input_scale) + input_zero_point);
-            if (q > 127) q = 127;
-            if (q < -128) q = -128;
-            // Write directly to input tensor
-            input_ptr[i * NUMBER_CEPS + j] = static_cast<int8_t>(q);
-        }
-    }
+    // Frames are already quantized, copy the window into the input tensor
+    std::memcpy(classifier->input(0)->data.int8, window.data(), window.size());
 
     // Run classifier
-    if (classifier->Invoke() != kTfLiteOk) {
+    TfLiteStatus status;
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::INVOKE);
+        status = classifier->Invoke();
+    }
+    if (status != kTfLiteOk) {
         ESP_LOGI(TAG, "Classifier Invoke() failed");
-        return;
+        return -1;
     }
 
     // Get output
-    TfLiteTensor* output = classifier->output(0);
-    float output_scale = output->params.scale;
-    int output_zero_point = output->params.zero_point;
-
-    int max_idx = 0;
-    float max_result = 0.0f;
-
-    for (int i = 0; i < kCategoryCount; i++) {
-        float score = (tflite::GetTensorData<int8_t>(output)[i] - output_zero_point) * output_scale;
-        if (score > max_result) {
-            max_result = score;
-            max_idx = i;
-        }
-    }
+    const int8_t* scores = tflite::GetTensorData<int8_t>(classifier->output(0));
+    int detected = detect_category(scores);
 
-    if (max_result > 0.65f) {
-        ESP_LOGI(TAG, "Detected %7s, score: %.2f", kCategoryLabels[max_idx], static_cast<double>(max_result));
+    if (detected >= 0) {
+        float score = dequantize_score(scores[detected]);
+        ESP_LOGI(TAG, "Detected %7s, score: %.2f", kCategoryLabels[detected], static_cast<double>(score));
     }
+    return detected;
 }
@@ -1,43 +1,21 @@
-// Legacy library
-//#include "driver/i2s.h"
 #include "freertos/FreeRTOS.h" 
 #include "freertos/task.h"
-#include "driver/i2s_std.h"
-#include "driver/gpio.h"
 #include "esp_log.h"
 #include "esp_err.h"
+#include "esp_attr.h"
 
 #include "audio_sampling.h"
 
 static const char* TAG = "audio_sampling";
 
-TaskHandle_t task_handle = nullptr;
-i2s_chan_handle_t rx_handle = nullptr;
-
-RingBuffer<int16_t, RING_BUFFER_LEN, FRAME_SIZE, FRAME_STRIDE> ring_buffer;
-
-static size_t accumulated_samples = 0;
-
-static bool IRAM_ATTR i2s_rx_callback(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx) 
+bool IRAM_ATTR I2sSource::on_receive(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
 {
     BaseType_t high_task_wakeup = pdFALSE;
 
-    size_t samples_available = event->size / sizeof(int16_t);
-
-    int16_t temp_buffer[samples_available];
-    size_t bytes_read = 0;
-
-    i2s_channel_read(handle, temp_buffer, event->size, &bytes_read, 0);
-
-    ring_buffer.write_samples(temp_buffer, samples_available);
-
-    accumulated_samples += samples_available;
-
-    if (accumulated_samples >= FRAME_STRIDE)  // 320
-    {
-        accumulated_samples -= FRAME_STRIDE;
-        vTaskNotifyGiveFromISR(task_handle, &high_task_wakeup);
-    }
+    // Pre-emphasis straight from the completed DMA block into ring storage,
+    // one notification per completed stride (320)
+    const int16_t* dma_samples = static_cast<const int16_t*>(event->dma_buf);
+    static_cast<I2sSource*>(user_ctx)->sink->deliver_from_isr(dma_samples, event->size / sizeof(int16_t), &high_task_wakeup);
 
     if (high_task_wakeup)
         portYIELD_FROM_ISR();
@@ -45,9 +23,12 @@ static bool IRAM_ATTR i2s_rx_callback(i2s_chan_handle_t handle, i2s_event_data_t
     return high_task_wakeup == pdTRUE;
 }
 
-void i2s_install(void)
+void I2sSource::start(AudioSink& target)
 {
+    sink = &target;
+
     i2s_chan_config_t chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG(I2S_NUM_AUTO, I2S_ROLE_MASTER);
+    chan_cfg.dma_frame_num = I2S_DMA_FRAME_SAMPLES;
 
     /* Allocate a new RX channel and get the handle of this channel */
     ESP_ERROR_CHECK(i2s_new_channel(&chan_cfg, NULL, &rx_handle));
@@ -58,10 +39,10 @@ void i2s_install(void)
         .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_MONO), 
         .gpio_cfg = { 
             .mclk = I2S_GPIO_UNUSED, 
-            .bclk = GPIO_NUM_26, 
-            .ws = GPIO_NUM_32, 
+            .bclk = pins.bclk, 
+            .ws = pins.ws, 
             .dout = I2S_GPIO_UNUSED, 
-            .din = GPIO_NUM_33, 
+            .din = pins.din, 
             .invert_flags = { 
                 .mclk_inv = false, 
                 .bclk_inv = false, 
@@ -75,11 +56,59 @@ void i2s_install(void)
 
     // Register the callback
     i2s_event_callbacks_t cbs = {};
-    cbs.on_recv = i2s_rx_callback;
+    cbs.on_recv = on_receive;
     
-    ESP_ERROR_CHECK(i2s_channel_register_event_callback(rx_handle, &cbs, task_handle));
+    ESP_ERROR_CHECK(i2s_channel_register_event_callback(rx_handle, &cbs, this));
 
     ESP_ERROR_CHECK(i2s_channel_enable(rx_handle));
 
     ESP_LOGI(TAG, "I2S enable\n");
 }
+
+UartSource::UartSource(const UartPcmConfig& config)
+    : StreamSource({1.0f, true, false, nullptr}), config(config)
+{
+}
+
+void UartSource::start(AudioSink& sink)
+{
+    uart_config_t uart_cfg = {};
+    uart_cfg.baud_rate = config.baud_rate;
+    uart_cfg.data_bits = UART_DATA_8_BITS;
+    uart_cfg.parity = UART_PARITY_DISABLE;
+    uart_cfg.stop_bits = UART_STOP_BITS_1;
+    uart_cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    uart_cfg.source_clk = UART_SCLK_DEFAULT;
+
+    // RX buffer of a few DMA blocks absorbs the ring backpressure
+    ESP_ERROR_CHECK(uart_driver_install(config.port, 8 * I2S_DMA_FRAME_SAMPLES * sizeof(int16_t), 0, 0, NULL, 0));
+    ESP_ERROR_CHECK(uart_param_config(config.port, &uart_cfg));
+    ESP_ERROR_CHECK(uart_set_pin(config.port, UART_PIN_NO_CHANGE, config.rx_pin, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE));
+
+    ESP_LOGI(TAG, "UART %d PCM input at %d baud", (int)config.port, config.baud_rate);
+    StreamSource::start(sink);
+}
+
+size_t UartSource::fill(int16_t* block, size_t count)
+{
+    // Whole samples only: wait for the full block
+    int read = uart_read_bytes(config.port, block, count * sizeof(int16_t), portMAX_DELAY);
+    return read > 0 ? size_t(read) / sizeof(int16_t) : 0;
+}
+
+AudioSource& select_audio_source(void)
+{
+#if defined(KEWOKE_AUDIO_SOURCE_UART)
+    static UartSource source;
+#elif defined(KEWOKE_AUDIO_SOURCE_SYNTHETIC)
+    StreamOptions options;
+    options.loop = true;
+#ifdef KEWOKE_REPLAY_MAX_SPEED
+    options.max_speed = true;
+#endif
+    static SyntheticSource source(SyntheticSource::test_scene(), SyntheticSource::TEST_SCENE_LENGTH, options);
+#else
+    static I2sSource source;
+#endif
+    return source;
+}
@@ -1,14 +1,64 @@
-
 #pragma once
 #include <stdint.h>
 #include <stddef.h>
-#include "mfcc_constants.hpp"
-#include "ring_buffer.hpp"
+#include "driver/i2s_std.h"
+#include "driver/gpio.h"
+#include "driver/uart.h"
+#include "audio_source.hpp"
+
+// I2S microphone wiring
+struct I2sPins
+{
+    gpio_num_t bclk;
+    gpio_num_t ws;
+    gpio_num_t din;
+};
+
+// ESP-EYE on-board microphone
+constexpr I2sPins ESP_EYE_MIC_PINS = {GPIO_NUM_26, GPIO_NUM_32, GPIO_NUM_33};
+
+// I2S microphone, 16-bit mono at SAMPLE_RATE: each DMA block is delivered
+// to the sink from the receive ISR
+class I2sSource : public AudioSource
+{
+public:
+    explicit I2sSource(const I2sPins& pins = ESP_EYE_MIC_PINS) : pins(pins) {}
+
+    void start(AudioSink& sink) override;
+    const char* name() const override { return "i2s"; }
+
+private:
+    static bool on_receive(i2s_chan_handle_t handle, i2s_event_data_t* event, void* user_ctx);
+
+    I2sPins pins;
+    i2s_chan_handle_t rx_handle = nullptr;
+    AudioSink* sink = nullptr;
+};
+
+struct UartPcmConfig
+{
+    uart_port_t port;
+    int baud_rate;      // 921600 carries up to ~2.9x real time
+    int rx_pin;         // UART_PIN_NO_CHANGE keeps the port's default pin
+};
+
+// Console UART, at a baud rate fast enough for real time
+constexpr UartPcmConfig UART_PCM_DEFAULT = {UART_NUM_0, 921600, UART_PIN_NO_CHANGE};
 
-extern TaskHandle_t task_handle;  // Handle for the MFCC task
-constexpr size_t RING_BUFFER_LEN = 2*1024;
+// Raw 16-bit little-endian PCM sent by a host over a UART, e.g.
+//   stty -F /dev/ttyUSB0 921600 raw && cat recording.pcm > /dev/ttyUSB0
+// Paced by the link, with ring backpressure rather than overruns
+class UartSource : public StreamSource
+{
+public:
+    explicit UartSource(const UartPcmConfig& config = UART_PCM_DEFAULT);
 
-extern RingBuffer<int16_t, RING_BUFFER_LEN, FRAME_SIZE, FRAME_STRIDE> ring_buffer;
+    void start(AudioSink& sink) override;
+    const char* name() const override { return "uart"; }
 
+protected:
+    size_t fill(int16_t* block, size_t count) override;
 
-void i2s_install(void);
\ No newline at end of file
+private:
+    UartPcmConfig config;
+};
@@ -0,0 +1,96 @@
+// Linux target stand-in for audio_sampling.cpp: replays a 16 kHz mono 16-bit
+// PCM file, or the synthetic test scene, through the same sink as the I2S ISR.
+//
+//   KEWOKE_AUDIO_FILE    raw PCM or WAV file, the synthetic test scene if unset
+//   KEWOKE_SYNTH_CLIP    raw PCM or WAV clip mixed into the test scene at 8.5 s
+//   KEWOKE_REPLAY_SPEED  1 for real time, 4 for 4x faster, ..., or max to run
+//                        as fast as the pipeline drains the ring (default 1)
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "audio_source.hpp"
+#include "wav_file.hpp"
+
+static const char* TAG = "audio_sampling";
+
+// File contents, the sources replay them in place
+static std::vector<uint8_t> audio_file;
+static std::vector<uint8_t> clip_file;
+
+static bool load_pcm(const char* path, std::vector<uint8_t>& bytes, PcmView& pcm)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == nullptr)
+    {
+        ESP_LOGE(TAG, "Cannot read %s", path);
+        return false;
+    }
+
+    uint8_t chunk[4096];
+    size_t count;
+    while ((count = fread(chunk, 1, sizeof(chunk), file)) > 0)
+        bytes.insert(bytes.end(), chunk, chunk + count);
+    fclose(file);
+
+    if (bytes.size() >= 4 && memcmp(bytes.data(), "RIFF", 4) == 0)
+    {
+        const char* error = parse_wav(bytes.data(), bytes.size(), pcm);
+        if (error != nullptr)
+            ESP_LOGE(TAG, "%s: %s", path, error);
+        return error == nullptr;
+    }
+
+    pcm = {reinterpret_cast<const int16_t*>(bytes.data()), bytes.size() / sizeof(int16_t)};
+    return true;
+}
+
+// End of the replay: let the pipeline drain, then end the process so perf runs terminate
+static void replay_done(void)
+{
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    exit(0);
+}
+
+AudioSource& select_audio_source(void)
+{
+    StreamOptions options;
+    options.on_end = replay_done;
+
+    const char* speed = getenv("KEWOKE_REPLAY_SPEED");
+    if (speed != nullptr && strcmp(speed, "max") == 0)
+        options.max_speed = true;
+    else if (speed != nullptr && atof(speed) > 0)
+        options.speed = float(atof(speed));
+
+    PcmView pcm = {nullptr, 0};
+    const char* path = getenv("KEWOKE_AUDIO_FILE");
+    if (path != nullptr)
+    {
+        if (!load_pcm(path, audio_file, pcm))
+            exit(1);
+
+        ESP_LOGI(TAG, "Replaying %s: %.2f s", path, double(pcm.count) / SAMPLE_RATE);
+        static ReplaySource replay(pcm.samples, pcm.count, options);
+        return replay;
+    }
+
+    const char* clip_path = getenv("KEWOKE_SYNTH_CLIP");
+    if (clip_path != nullptr && !load_pcm(clip_path, clip_file, pcm))
+        exit(1);
+
+    uint32_t length = SyntheticSource::TEST_SCENE_LENGTH;
+    if (pcm.count > 0)
+    {
+        ESP_LOGI(TAG, "Clip %s at %.2f s", clip_path, SyntheticSource::TEST_SCENE_CLIP_S);
+        length = std::max<uint32_t>(length, uint32_t(SyntheticSource::TEST_SCENE_CLIP_S * SAMPLE_RATE) + pcm.count);
+    }
+
+    static SyntheticSource synthetic(SyntheticSource::test_scene(pcm.samples, pcm.count), length, options);
+    return synthetic;
+}
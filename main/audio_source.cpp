@@ -0,0 +1,177 @@
+#include <cmath>
+#include <cstring>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "audio_source.hpp"
+
+static const char* TAG = "audio_source";
+
+void StreamSource::start(AudioSink& target)
+{
+    sink = &target;
+    // Above every pipeline task, as the ISR it stands in for
+    xTaskCreate(task, "AudioSource", 4096, this, configMAX_PRIORITIES - 1, NULL);
+}
+
+void StreamSource::task(void* arg)
+{
+    static_cast<StreamSource*>(arg)->run();
+}
+
+void StreamSource::run()
+{
+    const int64_t block_us = int64_t(1000000.0 * I2S_DMA_FRAME_SAMPLES / SAMPLE_RATE / options.speed);
+    int16_t block[I2S_DMA_FRAME_SAMPLES];
+
+    for (;;)
+    {
+        RingBufferStats before = sink->get_ring().stats();
+        int64_t start_us = esp_timer_get_time();
+        size_t samples = 0;
+        size_t blocks = 0;
+        size_t count;
+
+        while ((count = fill(block, I2S_DMA_FRAME_SAMPLES)) > 0)
+        {
+            if (options.max_speed)
+            {
+                sink->wait_for_space(count);
+            }
+            else
+            {
+                // Block n completes at start + (n + 1) block periods, as the DMA would
+                blocks++;
+                int64_t wait_us = start_us + int64_t(blocks) * block_us - esp_timer_get_time();
+                if (wait_us >= portTICK_PERIOD_MS * 1000)
+                    vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+            }
+
+            sink->deliver(block, count);
+            samples += count;
+        }
+
+        double audio_s = double(samples) / SAMPLE_RATE;
+        double elapsed_s = (esp_timer_get_time() - start_us) / 1e6;
+        RingBufferStats after = sink->get_ring().stats();
+        ESP_LOGI(TAG, "%s: %.2f s audio in %.2f s (x%.1f real time), %lu overruns",
+                 name(), audio_s, elapsed_s, elapsed_s > 0 ? audio_s / elapsed_s : 0.0,
+                 (unsigned long)(after.overrun_events - before.overrun_events));
+
+        if (!options.loop)
+            break;
+        rewind();
+    }
+
+    if (options.on_end != nullptr)
+        options.on_end();
+    vTaskDelete(NULL);
+}
+
+size_t ReplaySource::fill(int16_t* block, size_t size)
+{
+    size_t remaining = count - position;
+    if (size > remaining)
+        size = remaining;
+
+    std::memcpy(block, samples + position, size * sizeof(int16_t));
+    position += size;
+    return size;
+}
+
+SyntheticEvent SyntheticEvent::tone(float start_s, float duration_s, float frequency, int16_t amplitude)
+{
+    return {TONE, uint32_t(start_s * SAMPLE_RATE), uint32_t(duration_s * SAMPLE_RATE), frequency, frequency, amplitude, nullptr};
+}
+
+SyntheticEvent SyntheticEvent::chirp(float start_s, float duration_s, float from, float to, int16_t amplitude)
+{
+    return {CHIRP, uint32_t(start_s * SAMPLE_RATE), uint32_t(duration_s * SAMPLE_RATE), from, to, amplitude, nullptr};
+}
+
+SyntheticEvent SyntheticEvent::noise(float start_s, float duration_s, int16_t amplitude)
+{
+    return {NOISE, uint32_t(start_s * SAMPLE_RATE), uint32_t(duration_s * SAMPLE_RATE), 0.0f, 0.0f, amplitude, nullptr};
+}
+
+SyntheticEvent SyntheticEvent::clip_at(float start_s, const int16_t* samples, size_t count)
+{
+    return {CLIP, uint32_t(start_s * SAMPLE_RATE), uint32_t(count), 0.0f, 0.0f, 0, samples};
+}
+
+std::vector<SyntheticEvent> SyntheticSource::test_scene(const int16_t* clip, size_t clip_count)
+{
+    std::vector<SyntheticEvent> scene = {
+        SyntheticEvent::noise(0.0f, 7.0f, 30),
+        SyntheticEvent::tone(1.0f, 0.5f, 1000.0f, 8000),
+        SyntheticEvent::chirp(3.0f, 1.0f, 200.0f, 4000.0f, 8000),
+        SyntheticEvent::noise(5.5f, 0.5f, 6000),
+    };
+    // From 7 s to the clip stays digital silence
+    if (clip != nullptr)
+        scene.push_back(SyntheticEvent::clip_at(TEST_SCENE_CLIP_S, clip, clip_count));
+    return scene;
+}
+
+size_t SyntheticSource::fill(int16_t* block, size_t size)
+{
+    if (size > length - position)
+        size = length - position;
+
+    int32_t mix[I2S_DMA_FRAME_SAMPLES] = {};
+    if (size > I2S_DMA_FRAME_SAMPLES)
+        size = I2S_DMA_FRAME_SAMPLES;
+
+    for (const SyntheticEvent& event : events)
+    {
+        // Overlap of the event with [position, position + size)
+        uint32_t begin = event.start > position ? event.start : position;
+        uint32_t end = event.start + event.length < position + size ? event.start + event.length : position + size;
+
+        for (uint32_t n = begin; n < end; n++)
+        {
+            uint32_t t = n - event.start;
+            int32_t value = 0;
+
+            switch (event.kind)
+            {
+            case SyntheticEvent::TONE:
+            case SyntheticEvent::CHIRP:
+            {
+                // Phase in cycles, in double so that it stays exact over long events:
+                // f0 t + (f1 - f0) t^2 / (2 T)
+                double seconds = double(t) / SAMPLE_RATE;
+                double sweep = double(event.end_frequency - event.frequency) * seconds * seconds
+                               / (2.0 * event.length / SAMPLE_RATE);
+                double cycles = event.frequency * seconds + sweep;
+                float phase = float(cycles - std::floor(cycles));
+                value = int32_t(event.amplitude * std::sin(2.0f * float(M_PI) * phase));
+                break;
+            }
+            case SyntheticEvent::NOISE:
+                // xorshift32, uniform in ±amplitude
+                noise_state ^= noise_state << 13;
+                noise_state ^= noise_state >> 17;
+                noise_state ^= noise_state << 5;
+                value = (int32_t(noise_state >> 16) - 32768) * event.amplitude >> 15;
+                break;
+            case SyntheticEvent::CLIP:
+                value = event.clip[t];
+                break;
+            }
+
+            mix[n - position] += value;
+        }
+    }
+
+    for (size_t i = 0; i < size; i++)
+    {
+        int32_t value = mix[i];
+        if (value > INT16_MAX) value = INT16_MAX;
+        if (value < INT16_MIN) value = INT16_MIN;
+        block[i] = int16_t(value);
+    }
+
+    position += size;
+    return size;
+}
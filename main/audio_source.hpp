@@ -0,0 +1,187 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "mfcc_constants.hpp"
+#include "audio_ingest.hpp"
+
+// Landing point of every audio source: AudioIngest (pre-emphasis into the
+// audio ring) plus one notification of the consumer (MFCC task) per
+// completed frame
+class AudioSink
+{
+public:
+    using Ring = AudioIngest::Ring;
+
+    // Task notified once per frame, set before any source starts
+    void set_consumer(TaskHandle_t task) { consumer = task; }
+
+    // From an ISR (I2S DMA completion)
+    void deliver_from_isr(const int16_t* samples, size_t count, BaseType_t* high_task_wakeup)
+    {
+        for (uint32_t frames = ingest.write(samples, count); frames > 0; frames--)
+            vTaskNotifyGiveFromISR(consumer, high_task_wakeup);
+    }
+
+    // From a source task
+    void deliver(const int16_t* samples, size_t count)
+    {
+        for (uint32_t frames = ingest.write(samples, count); frames > 0; frames--)
+            xTaskNotifyGive(consumer);
+    }
+
+    // Block the calling source task until count samples fit in the ring
+    // (backpressure, for sources that may run ahead of real time)
+    void wait_for_space(size_t count)
+    {
+        while (ingest.free_space() < count)
+        {
+            waiting_producer.store(xTaskGetCurrentTaskHandle());
+            // The reader may have consumed before it could see the waiter, the
+            // tick timeout covers what this check misses
+            if (ingest.free_space() >= count)
+                break;
+            ulTaskNotifyTake(pdTRUE, 1);
+        }
+        waiting_producer.store(nullptr);
+    }
+
+    // Reader side, see RingBuffer::peek()
+    bool peek(RingSpan<const int16_t>& first, RingSpan<const int16_t>& second) { return ingest.peek(first, second); }
+
+    void consume(size_t size)
+    {
+        ingest.consume(size);
+        if (TaskHandle_t producer = waiting_producer.load())
+            xTaskNotifyGive(producer);
+    }
+
+    Ring& get_ring() { return ingest.get_ring(); }
+
+#ifdef KEWOKE_LATENCY_TRACE
+    uint32_t frame_ready_time_us(uint32_t frame) const { return ingest.frame_ready_time_us(frame); }
+#endif
+
+private:
+    AudioIngest ingest;
+
+    TaskHandle_t consumer = nullptr;
+    std::atomic<TaskHandle_t> waiting_producer{nullptr};
+};
+
+// Where the pipeline audio comes from (16 kHz mono 16-bit)
+class AudioSource
+{
+public:
+    virtual ~AudioSource() = default;
+
+    // Start delivering audio into sink, returns once the source runs
+    virtual void start(AudioSink& sink) = 0;
+    virtual const char* name() const = 0;
+};
+
+struct StreamOptions
+{
+    float speed = 1.0f;            // Pace at speed times real time...
+    bool max_speed = false;        // ...or as fast as the ring drains (backpressure only)
+    bool loop = false;             // Start over at the end of the stream
+    void (*on_end)(void) = nullptr; // Called at the end of the stream (unless loop)
+};
+
+// Source fed by its own task, in I2S DMA sized blocks. Each pass over the
+// stream logs its throughput and the ring overruns it caused.
+class StreamSource : public AudioSource
+{
+public:
+    explicit StreamSource(const StreamOptions& options) : options(options) {}
+
+    void start(AudioSink& sink) override;
+
+protected:
+    // Next block of at most count samples, 0 at the end of the stream
+    virtual size_t fill(int16_t* block, size_t count) = 0;
+
+    // Back to the start of the stream, for looping
+    virtual void rewind() {}
+
+private:
+    static void task(void* arg);
+    void run();
+
+    StreamOptions options;
+    AudioSink* sink = nullptr;
+};
+
+// Replay of samples held in memory (a decoded WAV file, an embedded clip)
+class ReplaySource : public StreamSource
+{
+public:
+    ReplaySource(const int16_t* samples, size_t count, const StreamOptions& options)
+        : StreamSource(options), samples(samples), count(count) {}
+
+    const char* name() const override { return "replay"; }
+
+protected:
+    size_t fill(int16_t* block, size_t size) override;
+    void rewind() override { position = 0; }
+
+private:
+    const int16_t* samples;
+    size_t count;
+    size_t position = 0;
+};
+
+// Test signal component, times in samples
+struct SyntheticEvent
+{
+    enum Kind { TONE, CHIRP, NOISE, CLIP };
+
+    Kind kind;
+    uint32_t start;
+    uint32_t length;
+    float frequency;         // TONE, CHIRP start (Hz)
+    float end_frequency;     // CHIRP end (Hz)
+    int16_t amplitude;       // Peak, NOISE is uniform in ±amplitude
+    const int16_t* clip;     // CLIP samples, played as is
+
+    static SyntheticEvent tone(float start_s, float duration_s, float frequency, int16_t amplitude);
+    static SyntheticEvent chirp(float start_s, float duration_s, float from, float to, int16_t amplitude);
+    static SyntheticEvent noise(float start_s, float duration_s, int16_t amplitude);
+    static SyntheticEvent clip_at(float start_s, const int16_t* samples, size_t count);
+};
+
+// Sum of tones, chirps, noise and clips at known offsets, rendered block by
+// block (no stream held in memory), silence where no event plays
+class SyntheticSource : public StreamSource
+{
+public:
+    SyntheticSource(std::vector<SyntheticEvent> events, uint32_t length, const StreamOptions& options)
+        : StreamSource(options), events(std::move(events)), length(length) {}
+
+    // 10 s scene: every kind of event with silence and a low noise floor
+    // between them, plus clip (if any) at TEST_SCENE_CLIP_S
+    static std::vector<SyntheticEvent> test_scene(const int16_t* clip = nullptr, size_t clip_count = 0);
+    static constexpr uint32_t TEST_SCENE_LENGTH = 10 * SAMPLE_RATE;
+    static constexpr float TEST_SCENE_CLIP_S = 8.5f;
+
+    const char* name() const override { return "synthetic"; }
+
+protected:
+    size_t fill(int16_t* block, size_t size) override;
+    void rewind() override { position = 0; }
+
+private:
+    std::vector<SyntheticEvent> events;
+    uint32_t length;
+    uint32_t position = 0;
+    uint32_t noise_state = 0x12345678;
+};
+
+// Source for this build (KEWOKE_AUDIO_SOURCE), defined with the target's sources
+AudioSource& select_audio_source(void);
@@ -0,0 +1,208 @@
+#include <cmath>
+#include <cstdlib>
+#include "esp_cpu.h"
+#include "esp_log.h"
+
+#include "benchmark.hpp"
+#include "mfcc_constants.hpp"
+#include "pre_emphasis.hpp"
+#include "audio_recognition.hpp"
+#include "broadcast_ring_buffer.hpp"
+
+static const char* TAG = "benchmark";
+
+constexpr int BENCHMARK_ITERATIONS = 100;
+
+// Average cycle count of fn() over BENCHMARK_ITERATIONS calls
+template <typename Fn>
+static uint32_t measure_cycles(Fn&& fn)
+{
+    uint32_t start = esp_cpu_get_cycle_count();
+    for (int i = 0; i < BENCHMARK_ITERATIONS; i++)
+        fn();
+    return (esp_cpu_get_cycle_count() - start) / BENCHMARK_ITERATIONS;
+}
+
+// Previous DCT implementation (double precision cosine per term), kept as reference
+static void reference_dct_float(const std::array<int16_t, NUMBER_FILTERS>& filter_banks,
+                                std::array<int16_t, NUMBER_CEPS>& coef)
+{
+    for (size_t k = 0; k < NUMBER_CEPS; k++)
+    {
+        int64_t acc = 0;
+
+        for (size_t n = 0; n < NUMBER_FILTERS; n++)
+        {
+            double angle = M_PI * (n + 0.5) * k / NUMBER_FILTERS;
+            int32_t cos_q15 = int32_t(std::round(std::cos(angle) * 32767.0));
+            acc += int64_t(filter_banks[n]) * cos_q15;
+        }
+
+        acc >>= 15;
+        coef[k] = int16_t(std::clamp<int64_t>(acc, -32768, 32767));
+    }
+}
+
+// Fill a frame with a 1 kHz tone so every stage works on realistic data
+static std::array<int16_t, FRAME_SIZE> make_test_frame()
+{
+    std::array<int16_t, FRAME_SIZE> frame{};
+    for (size_t i = 0; i < FRAME_SIZE; i++)
+        frame[i] = int16_t(8000.0f * sinf(2.0f * M_PI * 1000.0f * i / SAMPLE_RATE));
+    return frame;
+}
+
+static void benchmark_dct(MFCC<>& mfcc)
+{
+    mfcc.set_signal(make_test_frame());
+    mfcc.compute_coefficient();
+
+    const auto& filter_banks = mfcc.get_filter_banks();
+    std::array<int16_t, NUMBER_CEPS> reference{};
+
+    uint32_t float_cycles = measure_cycles([&] { reference_dct_float(filter_banks, reference); });
+    uint32_t fixed_cycles = measure_cycles([&] { mfcc.compute_DCT(); });
+
+    auto coef = mfcc.get_coefficient();
+    int max_error = 0;
+    for (size_t k = 0; k < NUMBER_CEPS; k++)
+        max_error = std::max(max_error, std::abs(coef[k] - reference[k]));
+
+    ESP_LOGI(TAG, "DCT float: %lu cycles/frame, Q15 table: %lu cycles/frame, max diff %d LSB",
+             (unsigned long)float_cycles, (unsigned long)fixed_cycles, max_error);
+}
+
+static void benchmark_fft(MFCC<>& mfcc)
+{
+#if !defined(FIXED_POINT)
+    const char* mode = "float";
+#elif FIXED_POINT == 32
+    const char* mode = "int32";
+#else
+    const char* mode = "int16 block scaled";
+#endif
+
+    auto frame = make_test_frame();
+    std::array<int16_t, FRAME_STRIDE> stride{};
+    PreEmphasis<PRE_EMPHASIS_DC_REMOVAL> pre_emphasis;
+
+    uint32_t pre_emphasis_cycles = measure_cycles([&] { pre_emphasis.process(stride.data(), FRAME_STRIDE); });
+    uint32_t window_cycles = measure_cycles([&] { mfcc.set_signal(frame); });
+    uint32_t fft_cycles = measure_cycles([&] { mfcc.compute_FFT(); });
+    uint32_t power_cycles = measure_cycles([&] { mfcc.compute_power_spectrum(); });
+
+    ESP_LOGI(TAG, "Pre-emphasis: %lu cycles/stride, window: %lu cycles/frame",
+             (unsigned long)pre_emphasis_cycles, (unsigned long)window_cycles);
+    ESP_LOGI(TAG, "FFT (%s): %lu cycles/frame, power spectrum: %lu cycles/frame",
+             mode, (unsigned long)fft_cycles, (unsigned long)power_cycles);
+}
+
+// Whole front end on a silent frame, with and without the early exit (left enabled as FrontEnd sets it)
+static void benchmark_silence(MFCC<>& mfcc)
+{
+    std::array<int16_t, FRAME_SIZE> frame{};
+    auto run = [&] { mfcc.set_signal(frame); mfcc.compute_coefficient(); };
+
+    mfcc.set_silence_threshold(0);
+    mfcc.set_silence_energy(INT32_MIN);
+    uint32_t full_cycles = measure_cycles(run);
+    // Template refreshes would add a full frame to some of the iterations
+    mfcc.set_silence_threshold(SILENCE_MEAN_SQUARE);
+    mfcc.set_silence_refresh(0);
+    uint32_t silent_cycles = measure_cycles(run);
+    mfcc.set_silence_refresh(SILENCE_REFRESH_FRAMES);
+
+    ESP_LOGI(TAG, "Silent frame: %lu cycles full front end, %lu cycles with early exit",
+             (unsigned long)full_cycles, (unsigned long)silent_cycles);
+}
+
+// Previous float quantization and dequantized argmax, kept as reference
+static void reference_quantize_float(const std::array<int16_t, NUMBER_CEPS>& coefficient,
+                                     FeatureStore::Row& quantized, float scale, int zero_point)
+{
+    for (size_t j = 0; j < NUMBER_CEPS; j++)
+    {
+        int32_t q = static_cast<int32_t>(std::round(coefficient[j] / scale) + zero_point);
+        quantized[j] = static_cast<int8_t>(std::clamp<int32_t>(q, -128, 127));
+    }
+}
+
+static int reference_detect_float(const int8_t* scores, float scale, int zero_point)
+{
+    int max_idx = 0;
+    float max_result = 0.0f;
+
+    for (int i = 0; i < kCategoryCount; i++)
+    {
+        float score = (scores[i] - zero_point) * scale;
+        if (score > max_result)
+        {
+            max_result = score;
+            max_idx = i;
+        }
+    }
+    return max_result > kDetectionThreshold ? max_idx : -1;
+}
+
+static void benchmark_quantization(MFCC<>& mfcc)
+{
+    const QuantizationParams& params = get_quantization();
+
+    mfcc.set_signal(make_test_frame());
+    mfcc.compute_coefficient();
+    auto coef = mfcc.get_coefficient();
+
+    FeatureStore::Row quantized{};
+    const int8_t scores[kCategoryCount] = {-128, -100, 90, -128, 20, -120, -128};
+    volatile int detected = 0;
+
+    uint32_t float_cycles = measure_cycles([&] {
+        reference_quantize_float(coef, quantized, params.input_scale, params.input_zero_point);
+        detected = reference_detect_float(scores, params.output_scale, params.output_zero_point);
+    });
+    uint32_t fixed_cycles = measure_cycles([&] {
+        quantize_frame(coef, quantized);
+        detected = detect_category(scores);
+    });
+
+    ESP_LOGI(TAG, "Quantize + argmax float: %lu cycles/frame, integer: %lu cycles/frame",
+             (unsigned long)float_cycles, (unsigned long)fixed_cycles);
+}
+
+// One stride written and one frame read per consumer, consumers keep up so nothing is dropped
+template <OverrunPolicy POLICY>
+static uint32_t measure_broadcast_ring()
+{
+    constexpr size_t CONSUMERS = 3;
+    static BroadcastRingBuffer<int16_t, 2048, CONSUMERS> ring({POLICY, POLICY, POLICY});
+    static std::array<int16_t, FRAME_SIZE> frame{};
+    std::array<int16_t, FRAME_STRIDE> stride{};
+
+    while (ring.write_samples(stride.data(), FRAME_STRIDE) && ring.available(0) < FRAME_SIZE) {}
+
+    return measure_cycles([&] {
+        ring.write_samples(stride.data(), FRAME_STRIDE);
+        for (size_t c = 0; c < CONSUMERS; c++)
+            ring.read_samples(c, frame.data(), FRAME_SIZE, FRAME_STRIDE);
+    });
+}
+
+static void benchmark_broadcast_ring()
+{
+    uint32_t block_cycles = measure_broadcast_ring<OverrunPolicy::BLOCK>();
+    uint32_t drop_oldest_cycles = measure_broadcast_ring<OverrunPolicy::DROP_OLDEST>();
+    uint32_t drop_slow_cycles = measure_broadcast_ring<OverrunPolicy::DROP_SLOW_READER>();
+
+    ESP_LOGI(TAG, "Broadcast ring, 1 stride in + 3 frames out: block %lu, drop oldest %lu, drop slow reader %lu cycles",
+             (unsigned long)block_cycles, (unsigned long)drop_oldest_cycles, (unsigned long)drop_slow_cycles);
+}
+
+void run_frontend_benchmark(MFCC<>& mfcc)
+{
+    ESP_LOGI(TAG, "Front-end benchmark (%d iterations)", BENCHMARK_ITERATIONS);
+    benchmark_dct(mfcc);
+    benchmark_fft(mfcc);
+    benchmark_silence(mfcc);
+    benchmark_quantization(mfcc);
+    benchmark_broadcast_ring();
+}
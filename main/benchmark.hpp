@@ -0,0 +1,6 @@
+#pragma once
+
+#include "mfcc.h"
+
+// Run the front-end cycle benchmark once at startup (KEWOKE_BENCHMARK builds)
+void run_frontend_benchmark(MFCC<>& mfcc);
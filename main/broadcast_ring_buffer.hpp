@@ -0,0 +1,263 @@
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <atomic>
+#include <tuple>
+#include <utility>
+
+#include "ring_buffer.hpp"
+
+// What the writer does when a consumer has no room left for a new block
+enum class OverrunPolicy : uint8_t
+{
+    BLOCK,            // Refuse the write for every consumer (backpressure, like RingBuffer)
+    DROP_OLDEST,      // Push this consumer's cursor forward, it loses its oldest samples
+    DROP_SLOW_READER, // Ignore this consumer, once lapped it skips to the newest samples
+};
+
+// Counters since start for one consumer
+struct BroadcastConsumerStats
+{
+    uint32_t dropped_samples; // Samples this consumer never got to read
+    uint32_t overrun_events;  // Times this consumer lost samples
+};
+
+// Single producer, multi consumer ring buffer: the writer fills the storage
+// once and every consumer reads it through its own cursor. Positions are free
+// running 32-bit counters, the storage index is position & (BUFFER_SIZE - 1).
+template<typename T, size_t BUFFER_SIZE, size_t CONSUMERS>
+class BroadcastRingBuffer
+{
+    static_assert(BUFFER_SIZE > 0, "BroadcastRingBuffer size must be > 0");
+    static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "BroadcastRingBuffer size must be a power of 2");
+    static_assert(CONSUMERS > 0, "BroadcastRingBuffer needs at least one consumer");
+
+public:
+    explicit BroadcastRingBuffer(const std::array<OverrunPolicy, CONSUMERS>& policies)
+        : policies(policies) {}
+
+    // Reserve size samples at the write position as up to two contiguous spans,
+    // to be filled in place and published with commit_write(). Applies every
+    // consumer's overrun policy first.
+    // Returns false if a BLOCK consumer does not have room for size samples
+    bool reserve_write(size_t size, RingSpan<T>& first, RingSpan<T>& second) {
+        if (size > BUFFER_SIZE) {
+            return false;
+        }
+
+        uint32_t current_write = write_position.load(std::memory_order_relaxed);
+
+        // Check every blocking consumer before dropping anything
+        for (size_t c = 0; c < CONSUMERS; c++) {
+            if (policies[c] != OverrunPolicy::BLOCK) continue;
+
+            uint32_t current_read = consumers[c].cursor.load(std::memory_order_acquire);
+            if (current_write - current_read + size > BUFFER_SIZE) {
+                blocked_writes.fetch_add(1, std::memory_order_relaxed);
+                return false; // Would overwrite unread data
+            }
+        }
+
+        // Oldest position that stays readable once the block is written
+        uint32_t oldest_kept = current_write + size - BUFFER_SIZE;
+        for (size_t c = 0; c < CONSUMERS; c++) {
+            if (policies[c] != OverrunPolicy::DROP_OLDEST) continue;
+
+            Consumer& consumer = consumers[c];
+            uint32_t current_read = consumer.cursor.load(std::memory_order_acquire);
+            while (int32_t(oldest_kept - current_read) > 0) {
+                // Fails if the consumer advanced meanwhile, current_read is then reloaded
+                if (consumer.cursor.compare_exchange_weak(current_read, oldest_kept,
+                                                          std::memory_order_acq_rel)) {
+                    consumer.dropped_samples.fetch_add(oldest_kept - current_read, std::memory_order_relaxed);
+                    consumer.overrun_events.fetch_add(1, std::memory_order_relaxed);
+                    break;
+                }
+            }
+        }
+
+        // Announce the region before filling it, lapped DROP_SLOW_READER consumers check it
+        reserve_position.store(current_write + size, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        size_t index = current_write & (BUFFER_SIZE - 1);
+        size_t until_end = BUFFER_SIZE - index;
+        first = {&buffer[index], size < until_end ? size : until_end};
+        second = {&buffer[0], size - first.size};
+
+        return true;
+    }
+
+    // Publish size samples written into the spans from reserve_write()
+    void commit_write(size_t size) {
+        uint32_t current_write = write_position.load(std::memory_order_relaxed);
+        write_position.store(current_write + size, std::memory_order_release);
+    }
+
+    // Write samples at the write position (with wrap-around)
+    // Returns false if a BLOCK consumer does not have room for size samples
+    bool write_samples(const T* src, size_t size) {
+        RingSpan<T> first;
+        RingSpan<T> second;
+        if (!reserve_write(size, first, second)) {
+            return false;
+        }
+
+        std::memcpy(first.data, src, first.size * sizeof(T));
+        std::memcpy(second.data, src + first.size, second.size * sizeof(T));
+
+        commit_write(size);
+
+        return true;
+    }
+
+    // Copy size samples at consumer's cursor into dest and advance it by advance
+    // (size by default). Safe for every policy: a copy the writer raced with is
+    // retried or discarded, never returned.
+    // Returns false if not enough data available
+    bool read_samples(size_t consumer_index, T* dest, size_t size, size_t advance = 0) {
+        Consumer& consumer = consumers[consumer_index];
+        if (advance == 0) advance = size;
+
+        switch (policies[consumer_index]) {
+        case OverrunPolicy::BLOCK: {
+            RingSpan<const T> first;
+            RingSpan<const T> second;
+            if (!peek(consumer_index, size, first, second)) {
+                return false;
+            }
+            copy_out(dest, first, second);
+            consume(consumer_index, advance);
+            return true;
+        }
+
+        case OverrunPolicy::DROP_OLDEST:
+            while (true) {
+                uint32_t current_read = consumer.cursor.load(std::memory_order_acquire);
+                uint32_t current_write = write_position.load(std::memory_order_acquire);
+                if (current_write - current_read < size) {
+                    return false;
+                }
+
+                copy_out(dest, spans(current_read, size));
+
+                // The writer moves the cursor before overwriting, so an unchanged cursor means an intact copy
+                if (consumer.cursor.compare_exchange_strong(current_read, current_read + advance,
+                                                            std::memory_order_acq_rel)) {
+                    return true;
+                }
+            }
+
+        case OverrunPolicy::DROP_SLOW_READER: {
+            uint32_t current_read = consumer.cursor.load(std::memory_order_relaxed);
+            uint32_t current_write = write_position.load(std::memory_order_acquire);
+            if (lapped(consumer, current_read)) {
+                return false;
+            }
+            if (current_write - current_read < size) {
+                return false;
+            }
+
+            copy_out(dest, spans(current_read, size));
+
+            // Discard the copy if the writer reached the region while we were reading it
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (lapped(consumer, current_read)) {
+                return false;
+            }
+
+            consumer.cursor.store(current_read + advance, std::memory_order_release);
+            return true;
+        }
+        }
+
+        return false;
+    }
+
+    // Readable region of size samples at consumer's cursor as up to two
+    // contiguous spans, valid until consume(). Zero copy, so only for BLOCK
+    // consumers: the writer never touches their unread samples.
+    // Returns false if not enough data available
+    bool peek(size_t consumer_index, size_t size, RingSpan<const T>& first, RingSpan<const T>& second) const {
+        uint32_t current_read = consumers[consumer_index].cursor.load(std::memory_order_relaxed);
+        uint32_t current_write = write_position.load(std::memory_order_acquire);
+        if (current_write - current_read < size) {
+            return false;
+        }
+
+        std::tie(first, second) = spans(current_read, size);
+        return true;
+    }
+
+    // Release the first size samples at a BLOCK consumer's cursor
+    void consume(size_t consumer_index, size_t size) {
+        std::atomic<uint32_t>& cursor = consumers[consumer_index].cursor;
+        cursor.store(cursor.load(std::memory_order_relaxed) + size, std::memory_order_release);
+    }
+
+    // Number of samples waiting for consumer (may exceed BUFFER_SIZE once a DROP_SLOW_READER consumer is lapped)
+    size_t available(size_t consumer_index) const {
+        uint32_t current_write = write_position.load(std::memory_order_acquire);
+        return current_write - consumers[consumer_index].cursor.load(std::memory_order_relaxed);
+    }
+
+    BroadcastConsumerStats stats(size_t consumer_index) const {
+        const Consumer& consumer = consumers[consumer_index];
+        return {
+            consumer.dropped_samples.load(std::memory_order_relaxed),
+            consumer.overrun_events.load(std::memory_order_relaxed),
+        };
+    }
+
+    // Writes refused because of a BLOCK consumer
+    uint32_t get_blocked_writes() const { return blocked_writes.load(std::memory_order_relaxed); }
+
+    T buffer[BUFFER_SIZE]; // Public for DMA access, see reserve_write()
+
+private:
+    struct Consumer
+    {
+        std::atomic<uint32_t> cursor{0};
+        std::atomic<uint32_t> dropped_samples{0};
+        std::atomic<uint32_t> overrun_events{0};
+    };
+
+    std::pair<RingSpan<const T>, RingSpan<const T>> spans(uint32_t position, size_t size) const {
+        size_t index = position & (BUFFER_SIZE - 1);
+        size_t until_end = BUFFER_SIZE - index;
+        RingSpan<const T> first = {&buffer[index], size < until_end ? size : until_end};
+        RingSpan<const T> second = {&buffer[0], size - first.size};
+        return {first, second};
+    }
+
+    static void copy_out(T* dest, const RingSpan<const T>& first, const RingSpan<const T>& second) {
+        std::memcpy(dest, first.data, first.size * sizeof(T));
+        std::memcpy(dest + first.size, second.data, second.size * sizeof(T));
+    }
+
+    static void copy_out(T* dest, const std::pair<RingSpan<const T>, RingSpan<const T>>& region) {
+        copy_out(dest, region.first, region.second);
+    }
+
+    // DROP_SLOW_READER: if the writer has reserved past the consumer's oldest
+    // sample, skip the whole backlog and resume at the write position
+    bool lapped(Consumer& consumer, uint32_t current_read) {
+        uint32_t reserved = reserve_position.load(std::memory_order_relaxed);
+        if (reserved - current_read <= BUFFER_SIZE) {
+            return false;
+        }
+
+        uint32_t current_write = write_position.load(std::memory_order_acquire);
+        consumer.dropped_samples.fetch_add(current_write - current_read, std::memory_order_relaxed);
+        consumer.overrun_events.fetch_add(1, std::memory_order_relaxed);
+        consumer.cursor.store(current_write, std::memory_order_relaxed);
+        return true;
+    }
+
+    const std::array<OverrunPolicy, CONSUMERS> policies;
+    std::array<Consumer, CONSUMERS> consumers;
+    std::atomic<uint32_t> write_position{0};
+    std::atomic<uint32_t> reserve_position{0};
+    std::atomic<uint32_t> blocked_writes{0};
+};
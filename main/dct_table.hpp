@@ -0,0 +1,22 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+// Compute DCT-II basis value cos(π/N * (n + 0.5) * k) in Q15
+inline int16_t dct_value(int N, int k, int n)
+{
+    double angle = M_PI * (n + 0.5) * k / N;
+    return int16_t(std::round(std::cos(angle) * 32767.0));
+}
+
+// Compute DCT-II basis LUT (K rows of N coefficients) at runtime
+template <size_t K, size_t N>
+inline std::array<std::array<int16_t, N>, K> make_dct_lut()
+{
+    std::array<std::array<int16_t, N>, K> lut{};
+    for (size_t k = 0; k < K; k++)
+        for (size_t n = 0; n < N; n++)
+            lut[k][n] = dct_value(N, k, n);
+    return lut;
+}
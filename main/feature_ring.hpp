@@ -0,0 +1,40 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+// Circular store of the most recent ROWS feature vectors. New rows overwrite
+// the oldest one, so a sliding window never needs to be shifted in memory.
+template<typename T, size_t ROWS, size_t COLUMNS>
+class FeatureRing
+{
+public:
+    using Row = std::array<T, COLUMNS>;
+
+    // Store a row as the newest one
+    void push(const Row& row)
+    {
+        rows[next] = row;
+        next = (next + 1) % ROWS;
+        if (count < ROWS) count++;
+    }
+
+    bool full() const { return count == ROWS; }
+
+    // Slot the next row will be written to, i.e. the oldest row of the current window
+    size_t next_row() const { return next; }
+
+    // Copy the window that ends just before slot end into dest, oldest row first
+    void copy_window(T* dest, size_t end) const
+    {
+        size_t tail_rows = ROWS - end;
+        std::memcpy(dest, rows[end].data(), tail_rows * sizeof(Row));
+        std::memcpy(dest + tail_rows * COLUMNS, rows[0].data(), end * sizeof(Row));
+    }
+
+private:
+    std::array<Row, ROWS> rows{};
+    size_t next = 0;
+    size_t count = 0;
+};
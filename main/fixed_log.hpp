@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+constexpr int32_t LN2_Q16 = 45426; // ln(2) in Q16
+
+// Compute ln(1 + i / 2^BITS) in Q16 for i in [0, 2^BITS] at runtime
+template <int BITS>
+inline std::array<int32_t, (1 << BITS) + 1> make_log_lut()
+{
+    std::array<int32_t, (1 << BITS) + 1> lut{};
+    for (size_t i = 0; i < lut.size(); i++)
+        lut[i] = int32_t(std::log(1.0 + double(i) / (1 << BITS)) * 65536.0 + 0.5);
+    return lut;
+}
+
+// Integer natural logarithm: count-leading-zeros exponent plus a 2^BITS entry
+// mantissa table. BITS trades table size for accuracy, INTERPOLATE adds one
+// multiply per call to interpolate linearly between table entries.
+template <int BITS, bool INTERPOLATE>
+struct FixedLog
+{
+    static_assert(BITS >= 1 && BITS <= 12, "FixedLog table must have 1 to 12 index bits");
+
+    inline static const auto LUT = make_log_lut<BITS>();
+
+    // ln(x / 2^FRAC_BITS) in Q8, x must be > 0
+    template <int FRAC_BITS>
+    static int32_t log_q8(uint64_t x)
+    {
+        int msb = 63 - __builtin_clzll(x);
+
+        // 32-bit mantissa fraction below the leading one
+        uint32_t frac = uint32_t(((x << (63 - msb)) << 1) >> 32);
+
+        int32_t mantissa;
+        if constexpr (INTERPOLATE)
+        {
+            uint32_t index = frac >> (32 - BITS);
+
+            // Remaining fraction in Q16
+            int32_t t = int32_t((frac << BITS) >> 16);
+            mantissa = LUT[index] + (((LUT[index + 1] - LUT[index]) * t) >> 16);
+        }
+        else
+        {
+            // Nearest entry, the table has one extra entry for ln(2)
+            uint32_t index = uint32_t((uint64_t(frac) + (1u << (31 - BITS))) >> (32 - BITS));
+            mantissa = LUT[index];
+        }
+
+        int32_t log_q16 = (msb - FRAC_BITS) * LN2_Q16 + mantissa;
+
+        // Q16 → Q8 with rounding
+        return (log_q16 + 128) >> 8;
+    }
+};
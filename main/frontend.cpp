@@ -0,0 +1,79 @@
+#include "frontend.hpp"
+#include "stage_profiler.hpp"
+
+static_assert(SILENCE_MARGIN_Q8 < VAD_THRESHOLD_Q8, "Frames skipped as silence must be below the speech threshold");
+
+FrontEnd::FrontEnd()
+{
+    mfcc.set_silence_threshold(SILENCE_MEAN_SQUARE);
+    mfcc.set_silence_refresh(SILENCE_REFRESH_FRAMES);
+}
+
+bool FrontEnd::process_frame(const RingSpan<const int16_t>& first, const RingSpan<const int16_t>& second)
+{
+    KEWOKE_PROFILE_SCOPE(ProfileStage::FRAME);
+
+    // Digital silence always takes the early exit, background noise only
+    // while no speech is active (the hangover keeps words whole). Compared in
+    // the log domain, the frame energy estimate tracks the mel energy the
+    // noise floor is learnt from within a few LSB.
+    int32_t silence_energy = INT32_MIN;
+    if (!voice_activity.active() && voice_activity.has_noise_floor())
+        silence_energy = voice_activity.get_noise_floor() + SILENCE_MARGIN_Q8;
+    mfcc.set_silence_energy(silence_energy);
+
+    // Window straight from ring storage into the FFT input
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::WINDOW);
+        mfcc.set_signal(first.data, first.size, second.data);
+    }
+    mfcc.compute_coefficient();
+    if (mfcc.is_silent())
+    {
+        silent_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Quantize once, as soon as the frame is produced
+    FeatureStore::Row quantized;
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::QUANTIZE);
+        quantize_frame(mfcc.get_coefficient(), quantized);
+    }
+    feature_store.push(quantized);
+    frames_since_inference++;
+
+    // Background frames keep the noise floor tracking, digital silence would
+    // drag it down to the log floor
+    bool digital_silence = mfcc.get_sum_squares() < uint64_t(SILENCE_MEAN_SQUARE) * FRAME_SIZE;
+    bool speech = digital_silence ? voice_activity.update_silent()
+                                  : voice_activity.update(mfcc.get_frame_energy());
+
+    if (!feature_store.full() || frames_since_inference < INFERENCE_HOP_FRAMES)
+    {
+        return false;
+    }
+    frames_since_inference = 0;
+
+    if (VAD_ENABLED && !speech)
+    {
+        skipped_windows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    triggered_windows.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+}
+
+void FrontEnd::copy_window(FeatureWindow& window) const
+{
+    feature_store.copy_window(window.data(), feature_store.next_row());
+}
+
+FrontEndStats FrontEnd::stats() const
+{
+    return {
+        silent_frames.load(std::memory_order_relaxed),
+        triggered_windows.load(std::memory_order_relaxed),
+        skipped_windows.load(std::memory_order_relaxed),
+    };
+}
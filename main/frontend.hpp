@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "mfcc.h"
+#include "mfcc_constants.hpp"
+#include "ring_buffer.hpp"
+#include "quantization.hpp"
+#include "voice_activity.hpp"
+
+// Frame counters since start
+struct FrontEndStats
+{
+    uint32_t silent_frames;     // Frames that took the silence early exit (digital silence or background)
+    uint32_t triggered_windows; // Windows handed to the classifier
+    uint32_t skipped_windows;   // Windows without voice activity
+};
+
+// Per-frame pipeline shared by the device tasks and the host tools: MFCC,
+// quantization into the feature store, voice activity and inference hop
+class FrontEnd
+{
+public:
+    FrontEnd();
+
+    // Process one frame read in place from the audio ring (second span empty
+    // unless the frame wraps). Returns true when a window should be classified
+    bool process_frame(const RingSpan<const int16_t>& first, const RingSpan<const int16_t>& second);
+
+    // Copy the latest NUM_FRAMES quantized frames, oldest first
+    void copy_window(FeatureWindow& window) const;
+
+    MFCC<>& get_mfcc() { return mfcc; }
+    int32_t get_noise_floor() const { return voice_activity.get_noise_floor(); }
+
+    // Safe to call from another task
+    FrontEndStats stats() const;
+
+private:
+    MFCC<> mfcc;
+
+    // Sliding window of the latest NUM_FRAMES coefficient vectors
+    FeatureStore feature_store;
+    size_t frames_since_inference = 0;
+
+    // Gates inference on voice activity (VAD_ENABLED)
+    VoiceActivityDetector<VAD_HANGOVER_FRAMES> voice_activity;
+
+    std::atomic<uint32_t> silent_frames{0};
+    std::atomic<uint32_t> triggered_windows{0};
+    std::atomic<uint32_t> skipped_windows{0};
+};
@@ -1,52 +1,79 @@
 
+#include <algorithm>
 #include <cstdio>
-#include <vector>
+#include <atomic>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
-#include "driver/uart.h"
 #include "esp_log.h"
-#include "esp_task_wdt.h"  // Required for Task Watchdog Timer functions
-#include "esp_heap_caps.h"
+#include "esp_timer.h"
 
 #include "ring_buffer.hpp"
-#include "audio_sampling.h"
+#include "audio_source.hpp"
 #include "audio_recognition.hpp"
 #include "mfcc.h"
-#include "ring_buffer.hpp"
 #include "mfcc_constants.hpp"
+#include "benchmark.hpp"
+#include "pipeline_stats.hpp"
+#include "window_mailbox.hpp"
+#include "frontend.hpp"
+#include "power_management.h"
+#include "stats_console.h"
 
 #define LOG_LOCAL_LEVEL ESP_LOG_VERBOSE
 
 static const char* TAG = "Main.cpp";
 
-// Ping/Pong buffers
-shared_buffer<int16_t> bufferA;
-shared_buffer<int16_t> bufferB;
+// Front end and inference run on separate cores when there are two (one on the linux target)
+constexpr BaseType_t FRONTEND_CORE = portNUM_PROCESSORS - 1;
+constexpr BaseType_t INFERENCE_CORE = 0;
 
-shared_buffer<int16_t>* write_buffer = &bufferA;
-shared_buffer<int16_t>* read_buffer  = &bufferB;
+// Newest complete window for the inference task, stale ones are dropped
+static WindowMailbox<FeatureWindow> window_mailbox;
 
+TaskHandle_t mfcc_handle = nullptr;
 TaskHandle_t inference_handle = nullptr;
 SemaphoreHandle_t normalize_sem = nullptr;
 
-static MFCC<> mfccProcessor;
-size_t index_coef;
+// Audio ring the selected source writes into, read by the MFCC task
+static AudioSink audio_sink;
+
+// MFCC, feature store and voice activity gate
+static FrontEnd front_end;
+
+// Time a burst of frames may run before the MFCC task yields the CPU
+constexpr int64_t MFCC_BURST_BUDGET_US = 10 * 1000;
+
+// 1 ms rounded up to a whole tick: pdMS_TO_TICKS(1) truncates to 0 below
+// 1 kHz (the ESP-IDF default is 100 Hz) and a zero delay only yields to
+// tasks of the same priority
+constexpr TickType_t ONE_MS_TICKS = std::max<TickType_t>(1, pdMS_TO_TICKS(1));
 
-enum class MfccStage {
-    IDLE,
-    PRE_EMPHASIS,
-    WINDOW,
-    FFT,
-    POWER,
-    MEL,
-    DCT,
-    STORE
-};
+#ifdef KEWOKE_LATENCY_TRACE
+static LatencyStats frame_latency;
+static uint32_t processed_frames = 0;
+#endif
+
+#ifdef KEWOKE_LATENCY_BASELINE
+// MFCC task scheduling before frames were drained in bursts, kept as the
+// reference for the latency trace: one frame per wakeup, run as a state
+// machine with a ONE_MS_TICKS delay after each of its 8 states
+constexpr int BASELINE_STATE_DELAYS = 8;
+#endif
+
+#ifdef KEWOKE_PIPELINE_STATS
+constexpr uint32_t STATS_PERIOD_MS = 5000;
+static CoreLoad<portNUM_PROCESSORS> core_load;
+static PeakValue frames_per_wakeup;
+#endif
 
 // Task prototypes
+void process_frame(const RingSpan<const int16_t>& first, const RingSpan<const int16_t>& second);
 void mfcc_task(void* arg);
 void inference_task(void* arg);
+void stats_task(void* arg);
+void duty_cycle_task(void* arg);
+void dump_pipeline(void);
 
 extern "C" void app_main(void)
 {
@@ -54,12 +81,35 @@ extern "C" void app_main(void)
 
     normalize_sem = xSemaphoreCreateBinary();
 
-    // Set up I2S
-    i2s_install();
     setup_recognition();
 
-    xTaskCreatePinnedToCore(mfcc_task, "MFCCtask", 6144, NULL, 4, &task_handle, 1);
-    xTaskCreate(inference_task, "InferenceTask", 1024 * 12, NULL, 1, &inference_handle);
+#ifdef KEWOKE_BENCHMARK
+    // Before the audio starts, so the benchmark has the CPU to itself
+    run_frontend_benchmark(front_end.get_mfcc());
+#endif
+
+    power_management_install();
+
+    xTaskCreatePinnedToCore(mfcc_task, "MFCCtask", 6144, NULL, 4, &mfcc_handle, FRONTEND_CORE);
+    xTaskCreatePinnedToCore(inference_task, "InferenceTask", 1024 * 12, NULL, 1, &inference_handle, INFERENCE_CORE);
+
+    // The source notifies the MFCC task, so it starts once the task exists
+    audio_sink.set_consumer(mfcc_handle);
+    AudioSource& source = select_audio_source();
+    source.start(audio_sink);
+    ESP_LOGI(TAG, "Audio source: %s", source.name());
+
+#ifdef KEWOKE_PROFILE
+    stats_console_install(dump_pipeline);
+#endif
+
+#ifdef KEWOKE_PIPELINE_STATS
+    xTaskCreate(stats_task, "StatsTask", 3072, NULL, 1, NULL);
+#endif
+
+#ifdef KEWOKE_DUTY_CYCLE
+    xTaskCreate(duty_cycle_task, "DutyCycleTask", 2048, NULL, 1, NULL);
+#endif
 
     ESP_LOGI(TAG, "Initialization End\n");
 }
@@ -71,103 +121,93 @@ extern "C" void app_main(void)
 void mfcc_task(void* arg)
 {
     ESP_LOGI(TAG, "MFCC task\n");
-    MfccStage stage = MfccStage::IDLE;
+    RingSpan<const int16_t> first;
+    RingSpan<const int16_t> second;
 
     for(;;)
     {
-        switch (stage)
+        // Wait for notification from the audio source (I2S ISR callback)
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+#ifdef KEWOKE_LATENCY_BASELINE
+        if (audio_sink.peek(first, second))
         {
-            case MfccStage::IDLE:
-                // Wait for notification from the I2S ISR callback
-                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-                std::array<int16_t, FRAME_SIZE> frame;
-
-                if (ring_buffer.read_samples(frame.data())) 
-                {
-
-                    /*
-                    // Find max absolute sample
-                    int16_t max_val = 0;
-                    for(int i = 0; i < FRAME_SIZE; i++) {
-                        if(abs(frame[i]) > max_val) max_val = abs(frame[i]);
-                    }
-
-                    // Avoid division by zero
-                    float norm_factor = (max_val == 0) ? 1.0f : 32767.0f / max_val;
-
-                    // Apply normalization safely
-                    for(int i = 0; i < FRAME_SIZE; i++) {
-                        float tmp = frame[i] * norm_factor;
-                        if(tmp > 32767.0f) tmp = 32767.0f;
-                        if(tmp < -32768.0f) tmp = -32768.0f;
-                        frame[i] = static_cast<int16_t>(tmp);
-                    }*/
-                    
-                    mfccProcessor.set_signal(frame);
-                    stage = MfccStage::PRE_EMPHASIS;
-                } 
-                else 
-                {
-                    // Wait for more data
-                    vTaskDelay(pdMS_TO_TICKS(1));
-                }
-                break;
-
-            case MfccStage::PRE_EMPHASIS:
-                mfccProcessor.apply_pre_emphasis();
-                stage = MfccStage::WINDOW;
-                break;
-
-            case MfccStage::WINDOW:
-                mfccProcessor.apply_hamming_window();
-                stage = MfccStage::FFT;
-                break;
-
-            case MfccStage::FFT:
-                mfccProcessor.compute_FFT();
-                stage = MfccStage::POWER;
-                break;
-
-            case MfccStage::POWER:
-                mfccProcessor.compute_power_spectrum();
-                stage = MfccStage::MEL;
-                break;
-
-            case MfccStage::MEL:
-                mfccProcessor.apply_mel_banks();
-                stage = MfccStage::DCT;
-                break;
-
-            case MfccStage::DCT:
-                mfccProcessor.compute_DCT();
-                stage = MfccStage::STORE;
-                break;
-
-            case MfccStage::STORE:
-                write_buffer->data()[index_coef] = mfccProcessor.get_coefficient();
-                index_coef++;
-                
-                if (index_coef == NUM_FRAMES)
-                {
-                    ESP_LOGD(TAG, "Buffer Full! Triggering Model...");
-                    auto temp = write_buffer;
-                    write_buffer = read_buffer;
-                    read_buffer = temp;
-
-                    index_coef = 0;
-
-                    xTaskNotify(inference_handle, 0, eNoAction);
-                }
-
-                //if(index_coef % 10 == 0)
-                    //xTaskNotify(inference_handle, 0, eNoAction);
-
-                stage = MfccStage::IDLE;
-                break;
+            // Read, then pre-emphasis ... DCT: the coefficients were stored after 7 delays
+            for (int state = 0; state < BASELINE_STATE_DELAYS - 1; state++)
+                vTaskDelay(ONE_MS_TICKS);
+            process_frame(first, second);
+            audio_sink.consume(FRAME_STRIDE);
+        }
+        vTaskDelay(ONE_MS_TICKS);
+        continue;
+#endif
+        power_burst_begin(PowerBurst::FRONTEND);
+
+        int64_t burst_start = esp_timer_get_time();
+#ifdef KEWOKE_PIPELINE_STATS
+        uint32_t drained_frames = 0;
+#endif
+
+        // Drain every complete frame in this wakeup, however many notifications are pending
+        while (audio_sink.peek(first, second))
+        {
+#ifdef KEWOKE_PIPELINE_STATS
+            int64_t frame_start = esp_timer_get_time();
+#endif
+            // Frame is read in place, then the stride is released to the source
+            process_frame(first, second);
+            audio_sink.consume(FRAME_STRIDE);
+
+            int64_t now = esp_timer_get_time();
+#ifdef KEWOKE_PIPELINE_STATS
+            core_load.add(xPortGetCoreID(), uint32_t(now - frame_start));
+            drained_frames++;
+#endif
+
+            // Yield on a time budget so lower priority tasks still run under backlog
+            if (now - burst_start > MFCC_BURST_BUDGET_US)
+            {
+                vTaskDelay(ONE_MS_TICKS);
+                burst_start = esp_timer_get_time();
+            }
         }
 
-        // Cooperative multitasking point
-        vTaskDelay(pdMS_TO_TICKS(1));
+        power_burst_end(PowerBurst::FRONTEND);
+
+#ifdef KEWOKE_PIPELINE_STATS
+        frames_per_wakeup.record(drained_frames);
+#endif
+    }
+}
+
+// Full front end for one frame, then store its coefficients
+void process_frame(const RingSpan<const int16_t>& first, const RingSpan<const int16_t>& second)
+{
+    bool window_ready = front_end.process_frame(first, second);
+
+#ifdef KEWOKE_LATENCY_TRACE
+    uint32_t ready_us = audio_sink.frame_ready_time_us(processed_frames);
+    frame_latency.record(uint32_t(esp_timer_get_time()) - ready_us);
+    processed_frames++;
+
+    if (frame_latency.count == NUM_FRAMES)
+    {
+        ESP_LOGI(TAG, "ISR to coefficient latency over %lu frames: min %lu us, mean %lu us, max %lu us",
+                 (unsigned long)frame_latency.count, (unsigned long)frame_latency.min_us,
+                 (unsigned long)frame_latency.mean_us(), (unsigned long)frame_latency.max_us);
+        frame_latency.reset();
+    }
+#endif
+
+    if (window_ready)
+    {
+        ESP_LOGD(TAG, "Window ready! Triggering Model...");
+
+        // Fill the slot this task owns, then make it the newest window
+        front_end.copy_window(window_mailbox.back());
+        window_mailbox.publish();
+
+        xTaskNotifyGive(inference_handle);
     }
 }
 
@@ -178,9 +218,106 @@ void inference_task(void* arg)
     for(;;)
     {   
         ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-        // Run inference
-        run_inference(read_buffer->data());
+        power_burst_begin(PowerBurst::INFERENCE);
+
+        const FeatureWindow* window;
+        while ((window = window_mailbox.receive()) != nullptr)
+        {
+#ifdef KEWOKE_PIPELINE_STATS
+            int64_t start = esp_timer_get_time();
+#endif
+            // Run inference on the newest window
+            run_inference(*window);
+
+#ifdef KEWOKE_PIPELINE_STATS
+            core_load.add(xPortGetCoreID(), uint32_t(esp_timer_get_time() - start));
+#endif
+        }
+
+        power_burst_end(PowerBurst::INFERENCE);
             
         //ESP_LOGI(TAG, "Model Done. Ready for new audio.");
     }
 }
+
+#ifdef KEWOKE_PIPELINE_STATS
+// Periodic pipeline report: per-core busy time of the pipeline tasks
+void stats_task(void* arg)
+{
+    uint32_t reported_silent_frames = 0;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(STATS_PERIOD_MS));
+
+        for (int core = 0; core < portNUM_PROCESSORS; core++)
+        {
+            uint32_t busy_us = core_load.take(core);
+            ESP_LOGI(TAG, "Core %d: pipeline busy %lu.%lu%%", core,
+                     (unsigned long)(busy_us / (STATS_PERIOD_MS * 10)),
+                     (unsigned long)(busy_us / STATS_PERIOD_MS % 10));
+        }
+        RingBufferStats ring = audio_sink.get_ring().stats();
+        audio_sink.get_ring().reset_peak_occupancy();
+        ESP_LOGI(TAG, "Ring: peak %lu / %u samples, %lu overruns (%lu samples dropped), %lu starvations",
+                 (unsigned long)ring.peak_occupancy, (unsigned)RING_BUFFER_LEN,
+                 (unsigned long)ring.overrun_events, (unsigned long)ring.dropped_samples,
+                 (unsigned long)ring.starvation_events);
+        ESP_LOGI(TAG, "Frames per wakeup peak: %lu", (unsigned long)frames_per_wakeup.take());
+        ESP_LOGI(TAG, "Dropped windows: %lu", (unsigned long)window_mailbox.dropped_count());
+
+        FrontEndStats front = front_end.stats();
+        uint32_t windows = front.triggered_windows + front.skipped_windows;
+        ESP_LOGI(TAG, "VAD: %lu of %lu windows skipped (%lu%%), noise floor %ld (ln Q8)",
+                 (unsigned long)front.skipped_windows, (unsigned long)windows,
+                 (unsigned long)(windows == 0 ? 0 : uint64_t(front.skipped_windows) * 100 / windows),
+                 (long)front_end.get_noise_floor());
+        // Counters are since start, the report is per period
+        ESP_LOGI(TAG, "Silent frames (front end skipped): %lu",
+                 (unsigned long)(front.silent_frames - reported_silent_frames));
+        reported_silent_frames = front.silent_frames;
+    }
+}
+#endif
+
+#ifdef KEWOKE_DUTY_CYCLE
+// Share of each second with a pipeline burst running, for battery sizing
+void duty_cycle_task(void* arg)
+{
+    constexpr uint32_t DUTY_PERIOD_MS = 1000;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(DUTY_PERIOD_MS));
+
+        DutyCycle duty = power_take_duty_cycle();
+        ESP_LOGI(TAG, "Active duty cycle: %lu.%lu%% (front end %lu.%lu%%, inference %lu.%lu%%)",
+                 (unsigned long)(duty.active_us / (DUTY_PERIOD_MS * 10)),
+                 (unsigned long)(duty.active_us / DUTY_PERIOD_MS % 10),
+                 (unsigned long)(duty.frontend_us / (DUTY_PERIOD_MS * 10)),
+                 (unsigned long)(duty.frontend_us / DUTY_PERIOD_MS % 10),
+                 (unsigned long)(duty.inference_us / (DUTY_PERIOD_MS * 10)),
+                 (unsigned long)(duty.inference_us / DUTY_PERIOD_MS % 10));
+    }
+}
+#endif
+
+#ifdef KEWOKE_PROFILE
+// Pipeline part of the console `stats` command
+void dump_pipeline(void)
+{
+    RingBufferStats ring = audio_sink.get_ring().stats();
+    printf("Audio ring: %u / %u samples queued, peak %lu, %lu overruns (%lu samples dropped), %lu starvations\n",
+           (unsigned)audio_sink.get_ring().available(), (unsigned)RING_BUFFER_LEN,
+           (unsigned long)ring.peak_occupancy, (unsigned long)ring.overrun_events,
+           (unsigned long)ring.dropped_samples, (unsigned long)ring.starvation_events);
+    printf("Stack free: MFCC task %lu bytes, inference task %lu bytes\n",
+           (unsigned long)uxTaskGetStackHighWaterMark(mfcc_handle),
+           (unsigned long)uxTaskGetStackHighWaterMark(inference_handle));
+
+    FrontEndStats front = front_end.stats();
+    printf("Windows: %lu classified, %lu skipped by VAD, %lu dropped; %lu silent frames\n",
+           (unsigned long)front.triggered_windows, (unsigned long)front.skipped_windows,
+           (unsigned long)window_mailbox.dropped_count(), (unsigned long)front.silent_frames);
+}
+#endif
@@ -4,28 +4,29 @@
 #include <cstdint>
 #include <cmath>
 #include <algorithm>
-#include "freertos/semphr.h"
+#include <cstdlib>
 
 #include "kissFFT/kiss_fftr.h"
 #include "hamming_window.hpp"
-
-constexpr int16_t INT16_MAX_VALUE = 32767;
-constexpr int16_t INT16_MIN_VALUE = -32768;
-constexpr int16_t ALPHA_Q15 = 31876; // 0.97 in Q15
+#include "dct_table.hpp"
+#include "fixed_log.hpp"
+#include "stage_profiler.hpp"
 
 constexpr int16_t SAMPLE_FREQ = 16000;
 
-template<typename T, int ROW = 50, int COLUMN = 40>
-class shared_buffer
-{
-private:
-    std::array<std::array<T, COLUMN>, ROW> buffer;
+// Mel log: 5-bit interpolated table, max error 0.54 Q8 LSB against logf.
+// Without interpolation the error is 2.5 LSB at 6 bits and 1 LSB at 8 bits.
+constexpr int MEL_LOG_LUT_BITS = 5;
+constexpr bool MEL_LOG_INTERPOLATE = true;
+constexpr int32_t MEL_LOG_FLOOR_Q30 = 108;  // 1e-7 in Q30, rounded up
+constexpr int16_t MEL_LOG_FLOOR_Q8 = -4126; // ln(1e-7) in Q8
 
-public:
-    std::array<std::array<T, COLUMN>, ROW>& data()
-    {
-        return buffer;
-    }
+// Nonzero span of one triangular filter inside MFCC::mel_weights
+struct MelSpan
+{
+    uint16_t start;   // First FFT bin with a nonzero weight
+    uint16_t length;  // Number of consecutive nonzero weights
+    uint16_t offset;  // Index of the first weight in the packed table
 };
 
 template <
@@ -43,13 +44,14 @@ public:
     inline static const float max_frequency_mel = 2595 * log10f(1 + (SAMPLE_FREQ / 2) / 700.0f);
 
     inline static const auto HAMMING = make_hamming_lut<FRAME_SIZE>();
+    inline static const auto DCT_BASIS = make_dct_lut<NUMBER_CEPS, NUMBER_FILTERS>();
+
+    using MelLog = FixedLog<MEL_LOG_LUT_BITS, MEL_LOG_INTERPOLATE>;
 
     MFCC();
     ~MFCC();
 
     // Methods
-    void apply_pre_emphasis();
-    void apply_hamming_window();
     void compute_FFT();
     void compute_power_spectrum();
     float from_mel_to_hz(float freq_mel);
@@ -57,28 +59,74 @@ public:
     void apply_mel_banks();
     void compute_DCT(); 
 
+    void set_signal(const int16_t* first, size_t first_size, const int16_t* second);
+    void set_signal(const int16_t* samples);
     void set_signal(const std::array<int16_t, FRAME_SIZE>& new_signal);
     void compute_coefficient();
     std::array<int16_t, NUMBER_CEPS> get_coefficient();
+    const std::array<int32_t, NFFT/2 + 1>& get_power_spectrum() const;
+    const std::array<int16_t, NUMBER_FILTERS>& get_filter_banks() const;
+    int16_t get_frame_energy() const;
+
+    // Frames whose windowed mean square is below mean_square skip the FFT,
+    // mel and DCT and output the silence template: the coefficients of an
+    // all-zero frame until the first refresh (0 disables)
+    void set_silence_threshold(uint32_t mean_square);
+    // Frames whose energy estimate (ln Q8 of the windowed mean square, see
+    // get_frame_energy() on a silent frame) is below energy_q8 skip them too
+    // (INT32_MIN disables)
+    void set_silence_energy(int32_t energy_q8);
+    // Compute the first of every frames consecutive frames below the threshold
+    // fully and make it the silence template, so skipped frames carry the
+    // current background instead of digital silence (0 never refreshes)
+    void set_silence_refresh(uint32_t frames);
+    bool is_silent() const;
+    // Sum of the windowed squares of the current frame
+    uint64_t get_sum_squares() const;
 
 private:
 
-    // frame
-    std::array<int16_t, FRAME_SIZE> frame{};
+    int32_t stage_samples(const int16_t* samples, size_t offset, size_t count);
+
+    // Loud frames (a full scale square wave) exceed int32 in the upper bins
+    static int32_t saturate_power(int64_t power) { return int32_t(std::min<int64_t>(power, INT32_MAX)); }
+
+    // FFT input: windowed frame followed by a zero-padded tail that is never written
+    alignas(16) std::array<kiss_fft_scalar, NFFT> fft_in{};
 
     // FFT
     kiss_fftr_cfg cfg;
     std::array<kiss_fft_cpx, NFFT/2 + 1> fft_out{};
+#ifdef FIXED_POINT
+    // Left shift applied to the samples before the integer FFT
+    int fft_shift = 0;
+#endif
     std::array<int32_t, NFFT/2 + 1> power_spectrum{};
 
-    // Mel filters
-    std::array<std::array<int16_t, NFFT/2 + 1>, NUMBER_FILTERS> mel_weights{};
+    // Mel filters: packed nonzero weights, each FFT bin belongs to at most two filters
+    std::array<MelSpan, NUMBER_FILTERS> mel_spans{};
+    std::array<int16_t, 2 * (NFFT/2 + 1)> mel_weights{};
 
     // Mel filter banks
     std::array<int16_t, NUMBER_FILTERS> filter_banks{};
+    int16_t frame_energy = MEL_LOG_FLOOR_Q8; // ln of the summed mel energies, Q8
 
     // MFC coefficients
     std::array<int16_t, NUMBER_CEPS> coef{};
+
+    // Silence early exit: sum of the windowed squares of the current frame,
+    // and the output of the last frame computed as a template (an all-zero
+    // frame at construction)
+    uint64_t sum_squares = 0;
+    uint64_t silence_sum_squares = 0;
+    int32_t silence_energy = INT32_MIN;
+    int16_t squares_energy = MEL_LOG_FLOOR_Q8; // ln(sum_squares / 2^16) in Q8, set when a threshold needs it
+    bool silent = false;
+    uint32_t silence_refresh_frames = 0;
+    uint32_t quiet_frames = 0;        // Consecutive frames below the threshold
+    bool capture_template = false;    // Current frame becomes the silence template
+    std::array<int16_t, NUMBER_FILTERS> silence_filter_banks{};
+    std::array<int16_t, NUMBER_CEPS> silence_coef{};
 };
 
 // PUBLIC METHODS
@@ -88,6 +136,12 @@ MFCC<F,ST,NF,NFFT, NCEPS>::MFCC()
 {
     cfg = kiss_fftr_alloc(NFFT, 0, nullptr, nullptr);
     compute_triangle_filters();
+
+    // Precompute the silence output from a zero frame
+    set_signal(std::array<int16_t, F>{});
+    compute_coefficient();
+    silence_filter_banks = filter_banks;
+    silence_coef = coef;
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
@@ -97,65 +151,126 @@ MFCC<F,ST,NF,NFFT, NCEPS>::~MFCC()
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
-void MFCC<F,ST,NF,NFFT, NCEPS>::set_signal(const std::array<int16_t, F>& new_signal)
+void MFCC<F,ST,NF,NFFT, NCEPS>::set_signal(const int16_t* first, size_t first_size, const int16_t* second)
 {
-    frame = new_signal;
-}
+    static_assert(F <= NFFT, "Frame must fit in the FFT input");
 
-// PRIVATE METHODS
+    // Frame split in two contiguous parts, e.g. a wrapped ring buffer region.
+    // Samples arrive already pre-emphasised (PreEmphasis runs once per sample on ingest).
+    sum_squares = 0;
+    int32_t peak = stage_samples(first, 0, first_size);
+    peak = std::max(peak, stage_samples(second, first_size, F - first_size));
 
-template <int F, int ST, int NF, int NFFT, int NCEPS>
-void MFCC<F,ST,NF,NFFT, NCEPS>::apply_pre_emphasis()
-{
-    // Start from the end to keep using the same array without overwrite
-    // usefull sample before calculation
-    for(size_t i = F - 1; i > 0; i--)
+    silent = sum_squares < silence_sum_squares;
+    if (silent || silence_energy != INT32_MIN)
     {
-        int32_t filtered = frame[i] - ((ALPHA_Q15 * frame[i-1]) >> 15);
+        squares_energy = sum_squares == 0 ? MEL_LOG_FLOOR_Q8 : int16_t(MelLog::template log_q8<16>(sum_squares));
+        silent = silent || squares_energy < silence_energy;
+    }
+    capture_template = false;
+    if (silent)
+    {
+        // The first quiet frame of every refresh period is computed as a template
+        capture_template = silence_refresh_frames != 0 && quiet_frames % silence_refresh_frames == 0;
+        quiet_frames++;
+        if (!capture_template)
+            return;
+        silent = false;
+    }
+    else
+    {
+        quiet_frames = 0;
+    }
 
-        if (filtered > INT16_MAX_VALUE) filtered = INT16_MAX_VALUE;
-        else if (filtered < INT16_MIN_VALUE) filtered = INT16_MIN_VALUE;
+#if defined(FIXED_POINT) && FIXED_POINT == 32
+    fft_shift = 15;
+#elif defined(FIXED_POINT)
+    // Block scaling: shift the whole frame up to the int16 headroom
+    fft_shift = peak == 0 ? 0 : std::max(__builtin_clz(uint32_t(peak)) - 17, 0);
 
-        frame[i] = static_cast<int16_t>(filtered);
+    if (fft_shift > 0)
+    {
+        for (size_t i = 0; i < F; i++)
+            fft_in[i] = int16_t(fft_in[i] << fft_shift);
     }
+#else
+    (void)peak;
+#endif
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
-void MFCC<F,ST,NF,NFFT, NCEPS>::apply_hamming_window()
+void MFCC<F,ST,NF,NFFT, NCEPS>::set_signal(const int16_t* samples)
 {
-    for (size_t j = 0; j < F; j++)
-        frame[j] = (frame[j] * HAMMING[j]) >> 15;
+    set_signal(samples, F, nullptr);
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
-void MFCC<F,ST,NF,NFFT, NCEPS>::compute_FFT()
+void MFCC<F,ST,NF,NFFT, NCEPS>::set_signal(const std::array<int16_t, F>& new_signal)
 {
-    std::array<kiss_fft_scalar, NFFT> fft_in{};
+    set_signal(new_signal.data());
+}
 
-    for (size_t j = 0; j < F; ++j) 
-    {
-        fft_in[j] = frame[j];  // direct copy
-    }
+// PRIVATE METHODS
 
-    for (size_t j = F; j < NFFT; ++j) 
+// Single pass over count samples: Hamming window and FFT input scaling into
+// fft_in[offset...], adds the windowed squares to sum_squares. Returns the peak
+// windowed magnitude for block scaling (int16 FFT only, 0 otherwise)
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+int32_t MFCC<F,ST,NF,NFFT, NCEPS>::stage_samples(const int16_t* samples, size_t offset, size_t count)
+{
+    int32_t peak = 0;
+
+    for (size_t j = 0; j < count; j++)
     {
-        fft_in[j] = 0;          // zero-padding
+        size_t i = offset + j;
+        int16_t windowed = int16_t((samples[j] * HAMMING[i]) >> 15);
+        sum_squares += uint32_t(windowed * windowed);
+
+#if !defined(FIXED_POINT)
+        fft_in[i] = windowed;
+#elif FIXED_POINT == 32
+        // Samples go to the top of the 32-bit range, kissFFT scales each stage down
+        fft_in[i] = int32_t(windowed) << 15;
+#else
+        fft_in[i] = windowed;
+        peak = std::max(peak, std::abs(int32_t(windowed)));
+#endif
     }
 
+    return peak;
+}
+
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+void MFCC<F,ST,NF,NFFT, NCEPS>::compute_FFT()
+{
     kiss_fftr(cfg, fft_in.data(), fft_out.data());
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
 void MFCC<F,ST,NF,NFFT, NCEPS>::compute_power_spectrum()
 {
+#ifdef FIXED_POINT
+    static_assert((NFFT & (NFFT - 1)) == 0, "Integer FFT scaling needs a power of 2 NFFT");
+
+    // kissFFT output is X * 2^fft_shift / NFFT, so |X|² / NFFT = |out|² * NFFT / 2^(2 * fft_shift)
+    int shift = 2 * fft_shift - __builtin_ctz(NFFT);
+
+    for(size_t j = 0; j < NFFT/2 + 1; j++)
+    {
+        int64_t magnitude = int64_t(fft_out[j].r) * fft_out[j].r +
+                            int64_t(fft_out[j].i) * fft_out[j].i;
+
+        power_spectrum[j] = saturate_power(shift >= 0 ? magnitude >> shift : magnitude << -shift);
+    }
+#else
     for(size_t j = 0; j < NFFT/2 + 1; j++)
     {
         int64_t real_part = int64_t(fft_out[j].r) * fft_out[j].r;
         int64_t im_part = int64_t(fft_out[j].i) * fft_out[j].i;
 
-        power_spectrum[j] = (real_part + im_part) / NFFT; // (magnitude² / NFFT)
+        power_spectrum[j] = saturate_power((real_part + im_part) / NFFT); // (magnitude² / NFFT)
     }
-    
+#endif
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
@@ -168,6 +283,7 @@ template <int F, int ST, int NF, int NFFT, int NCEPS>
 void MFCC<F,ST,NF,NFFT, NCEPS>::compute_triangle_filters()
 {
     float delta = (max_frequency_mel - min_frequency_mel) / (NF + 1);
+    uint16_t offset = 0;
 
     for (int f = 0; f < NF; f++)
     {
@@ -175,7 +291,8 @@ void MFCC<F,ST,NF,NFFT, NCEPS>::compute_triangle_filters()
         float f_center = from_mel_to_hz(delta * (f + 1));
         float f_max = from_mel_to_hz(delta * (f + 2));
 
-        //int32_t sum = 0; // For normalization
+        MelSpan& span = mel_spans[f];
+        span = {0, 0, offset};
 
         for (int bin = 0; bin < NFFT/2 + 1; bin++)
         {
@@ -187,95 +304,169 @@ void MFCC<F,ST,NF,NFFT, NCEPS>::compute_triangle_filters()
             else if (freq_hz < f_max) w = (f_max - freq_hz) / (f_max - f_center);
             else w = 0;
 
-            mel_weights[f][bin] = int16_t(w * 32767.f);
-            //sum += mel_weights[f][bin] * mel_weights[f][bin];
-        }
+            int16_t weight = int16_t(w * 32767.f);
+            if (weight == 0)
+                continue;
 
-        // Second pass: normalize
-        /*if (sum > 0)
-        {
-            for (int bin = 0; bin < NFFT/2 + 1; bin++)
-            {
-                mel_weights[f][bin] = (int32_t(mel_weights[f][bin]) * 32767) / sum;
-            }
-        }*/
+            // Triangles are convex: nonzero weights are contiguous
+            if (span.length == 0)
+                span.start = bin;
+
+            mel_weights[offset++] = weight;
+            span.length++;
+        }
     }
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
 void MFCC<F,ST,NF,NFFT, NCEPS>::apply_mel_banks()
 {
-    constexpr float LOG_FLOOR = 1e-7f;
-    constexpr float LOG_SCALE = 256.0f; // Q8
+    uint64_t total = 0;
 
     for(size_t filter = 0; filter < NF; filter++)
     {
+        const MelSpan& span = mel_spans[filter];
+        const int32_t* power = &power_spectrum[span.start];
+        const int16_t* weights = &mel_weights[span.offset];
+
         int64_t acc = 0;
 
-        for(int s = 0; s < NFFT/2 + 1; s++)
+        for(int s = 0; s < span.length; s++)
         {
-            acc += int64_t(power_spectrum[s]) * 
-                        int64_t(mel_weights[filter][s]);
+            acc += int64_t(power[s]) * int64_t(weights[s]);
         }
-        // Q15 → float
-        float energy = acc / (32768.0f * 32768.0f);
+        total += uint64_t(acc);
 
-        float log_energy = logf(std::max(energy, LOG_FLOOR));
+        // Energy is acc / 2^30 (Q15 weights), log written directly in Q8
+        if (acc < MEL_LOG_FLOOR_Q30)
+        {
+            filter_banks[filter] = MEL_LOG_FLOOR_Q8;
+            continue;
+        }
 
-        int32_t q = int32_t(log_energy * LOG_SCALE);
+        int32_t q = MelLog::template log_q8<30>(uint64_t(acc));
 
         filter_banks[filter] = int16_t(std::clamp(q, int32_t(-32768), int32_t(32767)));
     }
+
+    // One more log for the whole frame, used by the voice activity detector
+    frame_energy = total < MEL_LOG_FLOOR_Q30
+        ? MEL_LOG_FLOOR_Q8
+        : int16_t(std::clamp(MelLog::template log_q8<30>(total), int32_t(-32768), int32_t(32767)));
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
 void MFCC<F,ST,NF,NFFT, NCEPS>::compute_DCT()
 {
+    // Filter bank (Q8) * cos (Q15) products are pre-shifted by 8 so the
+    // NF-term sum stays within 32 bits
+    static_assert(NF <= 128, "DCT accumulator sized for at most 128 filters");
 
     // Loop over cepstral coefficients
     for (size_t k = 0; k < NCEPS; k++)
     {
-        int64_t acc = 0;
+        const auto& basis = DCT_BASIS[k];
+        int32_t acc = 0;
 
         // Loop over Mel filter banks
         for (size_t n = 0; n < NF; n++)
-        {
-            // Compute the angle: θ = π/NF * (n + 0.5) * k
-            double angle = M_PI * (n + 0.5) * k / NF;
+            acc += (int32_t(filter_banks[n]) * basis[n]) >> 8;
 
-            // Cosine in Q15
-            int32_t cos_q15 = int32_t(std::round(std::cos(angle) * 32767.0));
-
-            // Multiply filter bank (Q15) by cos (Q15) → Q30
-            acc += int64_t(filter_banks[n]) * cos_q15;
-        }
-
-        // Q30 → Q15
-        acc >>= 15;
+        // Q15 → Q8 (remaining 7 bits)
+        acc >>= 7;
 
         // Clamp to int16_t
-        coef[k] = int16_t(std::clamp(acc, -32768LL, 32767LL));
+        coef[k] = int16_t(std::clamp(acc, int32_t(-32768), int32_t(32767)));
     }
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
 void MFCC<F,ST,NF,NFFT,NCEPS>::compute_coefficient()
 {
-    apply_pre_emphasis();
+    if (silent)
+    {
+        // Mel energy sum tracks ln(sum_squares / 2^16) within a few Q8 LSB, one log keeps the VAD fed
+        filter_banks = silence_filter_banks;
+        coef = silence_coef;
+        frame_energy = squares_energy;
+        return;
+    }
+
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::FFT);
+        compute_FFT();
+    }
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::POWER_SPECTRUM);
+        compute_power_spectrum();
+    }
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::MEL_BANKS);
+        apply_mel_banks();
+    }
+    {
+        KEWOKE_PROFILE_SCOPE(ProfileStage::DCT);
+        compute_DCT();
+    }
+
+    if (capture_template)
+    {
+        silence_filter_banks = filter_banks;
+        silence_coef = coef;
+    }
+}
+
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+std::array<int16_t, NCEPS> MFCC<F,ST,NF,NFFT,NCEPS>::get_coefficient()
+{
+    return coef;
+}
+
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+const std::array<int32_t, NFFT/2 + 1>& MFCC<F,ST,NF,NFFT,NCEPS>::get_power_spectrum() const
+{
+    return power_spectrum;
+}
 
-    apply_hamming_window();
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+const std::array<int16_t, NF>& MFCC<F,ST,NF,NFFT,NCEPS>::get_filter_banks() const
+{
+    return filter_banks;
+}
 
-    compute_FFT();
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+int16_t MFCC<F,ST,NF,NFFT,NCEPS>::get_frame_energy() const
+{
+    return frame_energy;
+}
 
-    compute_power_spectrum();
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+void MFCC<F,ST,NF,NFFT,NCEPS>::set_silence_threshold(uint32_t mean_square)
+{
+    silence_sum_squares = uint64_t(mean_square) * F;
+}
+
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+void MFCC<F,ST,NF,NFFT,NCEPS>::set_silence_energy(int32_t energy_q8)
+{
+    silence_energy = energy_q8;
+}
 
-    apply_mel_banks();
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+void MFCC<F,ST,NF,NFFT,NCEPS>::set_silence_refresh(uint32_t frames)
+{
+    silence_refresh_frames = frames;
+    quiet_frames = 0;
+}
 
-    compute_DCT();
+template <int F, int ST, int NF, int NFFT, int NCEPS>
+bool MFCC<F,ST,NF,NFFT,NCEPS>::is_silent() const
+{
+    return silent;
 }
 
 template <int F, int ST, int NF, int NFFT, int NCEPS>
-std::array<int16_t, NCEPS> MFCC<F,ST,NF,NFFT,NCEPS>::get_coefficient()
+uint64_t MFCC<F,ST,NF,NFFT,NCEPS>::get_sum_squares() const
 {
-    return coef;
+    return sum_squares;
 }
\ No newline at end of file
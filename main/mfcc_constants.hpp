@@ -1,8 +1,38 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
 
 constexpr int16_t SAMPLE_RATE = 16000; // in Hz
 constexpr int FRAME_SIZE = 480;
 constexpr int FRAME_STRIDE = 320;
+constexpr int NUMBER_FILTERS = 40;
 constexpr int NUMBER_CEPS = 40;
-constexpr int NUM_FRAMES = 1 + (SAMPLE_RATE - FRAME_SIZE + FRAME_STRIDE - 1) / FRAME_STRIDE;
\ No newline at end of file
+constexpr int NUM_FRAMES = 1 + (SAMPLE_RATE - FRAME_SIZE + FRAME_STRIDE - 1) / FRAME_STRIDE;
+
+// Audio ring between the I2S ISR and the MFCC task, in samples
+constexpr size_t RING_BUFFER_LEN = 2*1024;
+
+// Samples per I2S DMA block, i.e. per ISR callback (mono, 16-bit)
+constexpr uint32_t I2S_DMA_FRAME_SAMPLES = 240;
+
+// Run inference every INFERENCE_HOP_FRAMES frames over the latest NUM_FRAMES
+constexpr int INFERENCE_HOP_FRAMES = 10;
+
+// Remove DC offset ahead of the streaming pre-emphasis
+constexpr bool PRE_EMPHASIS_DC_REMOVAL = false;
+
+// Only trigger inference on windows with voice activity, keep it active for a
+// whole window after the last loud frame so a keyword is classified at every position
+constexpr bool VAD_ENABLED = true;
+constexpr int VAD_HANGOVER_FRAMES = NUM_FRAMES;
+
+// Frames with a windowed mean square below this skip FFT, mel and DCT
+// (about -78 dBFS RMS: digital silence, a muted or disconnected microphone)
+constexpr uint32_t SILENCE_MEAN_SQUARE = 16;
+
+// Without voice activity, frames within SILENCE_MARGIN_Q8 of the VAD noise
+// floor skip them too (ln Q8, 3 dB, under VAD_THRESHOLD_Q8 so a skipped frame
+// is never speech). One frame in SILENCE_REFRESH_FRAMES of a quiet run is
+// computed to refresh the coefficients the skipped frames reuse.
+constexpr int32_t SILENCE_MARGIN_Q8 = 177;
+constexpr uint32_t SILENCE_REFRESH_FRAMES = 25;
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Min / mean / max of a duration in microseconds over a reporting window
+struct LatencyStats
+{
+    uint32_t min_us = UINT32_MAX;
+    uint32_t max_us = 0;
+    uint64_t total_us = 0;
+    uint32_t count = 0;
+
+    void record(uint32_t us)
+    {
+        if (us < min_us) min_us = us;
+        if (us > max_us) max_us = us;
+        total_us += us;
+        count++;
+    }
+
+    uint32_t mean_us() const { return count == 0 ? 0 : uint32_t(total_us / count); }
+
+    void reset() { *this = LatencyStats{}; }
+};
+
+// Busy time reported by the pipeline tasks, per core, between two reads
+template<int CORES>
+class CoreLoad
+{
+public:
+    void add(int core, uint32_t us) { busy_us[core].fetch_add(us, std::memory_order_relaxed); }
+
+    // Busy time since the previous call, then restart from zero
+    uint32_t take(int core) { return busy_us[core].exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> busy_us[CORES] = {};
+};
+
+// Largest value seen between two reads, safe to update from one task and read from another
+class PeakValue
+{
+public:
+    void record(uint32_t value)
+    {
+        if (value > peak.load(std::memory_order_relaxed))
+            peak.store(value, std::memory_order_relaxed);
+    }
+
+    // Peak since the previous call, then restart from zero
+    uint32_t take() { return peak.exchange(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint32_t> peak{0};
+};
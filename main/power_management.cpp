@@ -0,0 +1,125 @@
+#include "freertos/FreeRTOS.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#include "power_management.h"
+
+[[maybe_unused]] static const char* TAG = "power_management";
+
+constexpr int BURST_COUNT = 2;
+
+#if defined(KEWOKE_POWER_SAVE) && CONFIG_PM_ENABLE
+#define KEWOKE_PM_LOCKS 1
+#include "esp_pm.h"
+
+// Lowest CPU frequency DFS may select, the XTAL frequency
+constexpr int PM_MIN_FREQ_MHZ = 40;
+
+static esp_pm_lock_handle_t burst_locks[BURST_COUNT] = {};
+#endif
+
+#ifdef KEWOKE_DUTY_CYCLE
+static portMUX_TYPE duty_mux = portMUX_INITIALIZER_UNLOCKED;
+static int active_bursts = 0;
+static int64_t active_start_us = 0;
+static int64_t burst_start_us[BURST_COUNT] = {};
+static uint32_t active_us = 0;
+static uint32_t burst_us[BURST_COUNT] = {};
+#endif
+
+void power_management_install(void)
+{
+#if defined(KEWOKE_PM_LOCKS)
+    // The I2S driver holds its own APB lock while the channel is enabled, so DMA
+    // keeps running: light sleep only engages once audio capture stops, DFS
+    // still lowers the CPU clock between bursts
+    esp_pm_config_t pm_config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = PM_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#else
+        .light_sleep_enable = false,
+#endif
+    };
+    ESP_ERROR_CHECK(esp_pm_configure(&pm_config));
+
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "frontend", &burst_locks[int(PowerBurst::FRONTEND)]));
+    ESP_ERROR_CHECK(esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "inference", &burst_locks[int(PowerBurst::INFERENCE)]));
+
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", PM_MIN_FREQ_MHZ, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+             pm_config.light_sleep_enable ? "on" : "off (needs CONFIG_FREERTOS_USE_TICKLESS_IDLE)");
+#elif defined(KEWOKE_POWER_SAVE)
+    ESP_LOGW(TAG, "KEWOKE_POWER_SAVE needs CONFIG_PM_ENABLE, power management left off");
+#endif
+}
+
+void power_burst_begin(PowerBurst burst)
+{
+#if defined(KEWOKE_PM_LOCKS)
+    esp_pm_lock_acquire(burst_locks[int(burst)]);
+#endif
+
+#ifdef KEWOKE_DUTY_CYCLE
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&duty_mux);
+    if (active_bursts++ == 0)
+        active_start_us = now;
+    burst_start_us[int(burst)] = now;
+    portEXIT_CRITICAL(&duty_mux);
+#endif
+}
+
+void power_burst_end(PowerBurst burst)
+{
+#ifdef KEWOKE_DUTY_CYCLE
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&duty_mux);
+    if (--active_bursts == 0)
+        active_us += uint32_t(now - active_start_us);
+    burst_us[int(burst)] += uint32_t(now - burst_start_us[int(burst)]);
+    burst_start_us[int(burst)] = 0;
+    portEXIT_CRITICAL(&duty_mux);
+#endif
+
+#if defined(KEWOKE_PM_LOCKS)
+    esp_pm_lock_release(burst_locks[int(burst)]);
+#endif
+}
+
+#ifdef KEWOKE_DUTY_CYCLE
+DutyCycle power_take_duty_cycle(void)
+{
+    int64_t now = esp_timer_get_time();
+
+    portENTER_CRITICAL(&duty_mux);
+
+    // Bursts still running are split at the reporting boundary
+    if (active_bursts > 0)
+    {
+        active_us += uint32_t(now - active_start_us);
+        active_start_us = now;
+    }
+    for (int i = 0; i < BURST_COUNT; i++)
+    {
+        if (burst_start_us[i] != 0)
+        {
+            burst_us[i] += uint32_t(now - burst_start_us[i]);
+            burst_start_us[i] = now;
+        }
+    }
+
+    DutyCycle duty = {active_us, burst_us[int(PowerBurst::FRONTEND)], burst_us[int(PowerBurst::INFERENCE)]};
+    active_us = 0;
+    burst_us[0] = 0;
+    burst_us[1] = 0;
+
+    portEXIT_CRITICAL(&duty_mux);
+
+    return duty;
+}
+#endif
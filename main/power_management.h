@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+// Pipeline bursts that keep the CPU at full speed while they run
+enum class PowerBurst
+{
+    FRONTEND,
+    INFERENCE,
+};
+
+// Configure DFS and automatic light sleep (KEWOKE_POWER_SAVE builds with
+// CONFIG_PM_ENABLE), create one PM lock per burst
+void power_management_install(void);
+
+// Hold the burst's PM lock while it runs, also timed in KEWOKE_DUTY_CYCLE builds
+void power_burst_begin(PowerBurst burst);
+void power_burst_end(PowerBurst burst);
+
+#ifdef KEWOKE_DUTY_CYCLE
+// Time in µs with at least one burst running, and per burst, since the previous call
+struct DutyCycle
+{
+    uint32_t active_us;
+    uint32_t frontend_us;
+    uint32_t inference_us;
+};
+
+DutyCycle power_take_duty_cycle(void);
+#endif
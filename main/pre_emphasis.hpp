@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+constexpr int16_t INT16_MAX_VALUE = 32767;
+constexpr int16_t INT16_MIN_VALUE = -32768;
+constexpr int16_t ALPHA_Q15 = 31876; // 0.97 in Q15
+constexpr int16_t DC_POLE_Q15 = 32604; // 0.995 in Q15
+
+// Streaming pre-emphasis y[n] = x[n] - α x[n-1], optionally preceded by a
+// one-pole DC blocker. Filter state is carried across calls so every sample
+// is filtered exactly once, independently of how the stream is framed.
+template <bool DC_REMOVAL = false>
+class PreEmphasis
+{
+public:
+    // Filter count samples from src into dst (src == dst filters in place)
+    void process(const int16_t* src, int16_t* dst, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            int32_t x = src[i];
+
+            if constexpr (DC_REMOVAL)
+            {
+                // d[n] = x[n] - x[n-1] + p d[n-1]
+                int32_t d = x - dc_previous_input + ((DC_POLE_Q15 * dc_previous_output) >> 15);
+                if (d > INT16_MAX_VALUE) d = INT16_MAX_VALUE;
+                else if (d < INT16_MIN_VALUE) d = INT16_MIN_VALUE;
+
+                dc_previous_input = x;
+                dc_previous_output = d;
+                x = d;
+            }
+
+            int32_t filtered = x - ((ALPHA_Q15 * previous) >> 15);
+            previous = x;
+
+            if (filtered > INT16_MAX_VALUE) filtered = INT16_MAX_VALUE;
+            else if (filtered < INT16_MIN_VALUE) filtered = INT16_MIN_VALUE;
+
+            dst[i] = static_cast<int16_t>(filtered);
+        }
+    }
+
+    // Filter count samples in place
+    void process(int16_t* samples, size_t count) { process(samples, samples, count); }
+
+    void reset()
+    {
+        previous = 0;
+        dc_previous_input = 0;
+        dc_previous_output = 0;
+    }
+
+private:
+    int32_t previous = 0;
+    int32_t dc_previous_input = 0;
+    int32_t dc_previous_output = 0;
+};
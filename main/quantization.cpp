@@ -0,0 +1,101 @@
+#include <cmath>
+#include "quantization.hpp"
+
+// x * multiplier / 2^shift in integer arithmetic
+struct FixedMultiplier
+{
+    int32_t multiplier = 1 << 14;
+    int shift = 14;
+};
+
+// Input quantization (1 / scale and zero-point) and integer output threshold,
+// derived once the tensors are allocated
+static QuantizationParams quantization = {1.0f, 0, 1.0f, 0};
+static FixedMultiplier input_multiplier;
+static int32_t input_zero_point = 0;
+static int32_t output_zero_point = 0;
+static float output_scale = 1.0f;
+static int32_t detection_threshold_q = 127;
+
+// Represent real (> 0) as multiplier / 2^shift with a 15-bit multiplier, so
+// that an int16 input times the multiplier stays within 32 bits
+static FixedMultiplier make_fixed_multiplier(double real)
+{
+    int exponent = 0;
+    double mantissa = std::frexp(real, &exponent); // real = mantissa * 2^exponent, mantissa in [0.5, 1)
+
+    FixedMultiplier fixed;
+    fixed.multiplier = int32_t(std::round(mantissa * (1 << 15)));
+    fixed.shift = 15 - exponent;
+
+    if (fixed.multiplier == (1 << 15)) {
+        fixed.multiplier >>= 1;
+        fixed.shift--;
+    }
+
+    // Keep the shift usable: very small factors round to zero, large ones saturate
+    if (fixed.shift > 31) {
+        fixed.multiplier = 0;
+        fixed.shift = 31;
+    } else if (fixed.shift < 1) {
+        fixed.multiplier = INT16_MAX;
+        fixed.shift = 1;
+    }
+    return fixed;
+}
+
+void setup_quantization(const QuantizationParams& params)
+{
+    quantization = params;
+
+    input_multiplier = make_fixed_multiplier(1.0 / params.input_scale);
+    input_zero_point = params.input_zero_point;
+
+    // score > threshold  <=>  (q - zero_point) * scale > threshold  <=>  q > zero_point + threshold / scale
+    output_scale = params.output_scale;
+    output_zero_point = params.output_zero_point;
+    detection_threshold_q = int32_t(std::floor(output_zero_point + kDetectionThreshold / output_scale));
+}
+
+const QuantizationParams& get_quantization()
+{
+    return quantization;
+}
+
+// Quantize one frame of coefficients with the model input scale and zero-point
+void quantize_frame(const std::array<int16_t, NUMBER_CEPS>& coefficient, FeatureStore::Row& quantized)
+{
+    const int32_t multiplier = input_multiplier.multiplier;
+    const int shift = input_multiplier.shift;
+    const int32_t rounding = int32_t(1) << (shift - 1);
+
+    for (size_t j = 0; j < NUMBER_CEPS; j++) {
+        // q = round(x / scale) + zero_point, in integer only
+        int32_t q = ((coefficient[j] * multiplier + rounding) >> shift) + input_zero_point;
+        if (q > 127) q = 127;
+        if (q < -128) q = -128;
+        quantized[j] = static_cast<int8_t>(q);
+    }
+}
+
+// Index of the best category if its score passes kDetectionThreshold, -1 otherwise
+int detect_category(const int8_t* scores)
+{
+    // Only positive scores count, as with the dequantized comparison against 0
+    int max_idx = -1;
+    int32_t max_q = output_zero_point;
+
+    for (int i = 0; i < kCategoryCount; i++) {
+        if (scores[i] > max_q) {
+            max_q = scores[i];
+            max_idx = i;
+        }
+    }
+
+    return max_q > detection_threshold_q ? max_idx : -1;
+}
+
+float dequantize_score(int8_t score)
+{
+    return (score - output_zero_point) * output_scale;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "mfcc_constants.hpp"
+#include "feature_ring.hpp"
+
+// Model-ready (quantized) coefficient vectors of the latest NUM_FRAMES frames
+using FeatureStore = FeatureRing<int8_t, NUM_FRAMES, NUMBER_CEPS>;
+
+// One model input: NUM_FRAMES quantized frames, oldest first
+using FeatureWindow = std::array<int8_t, NUM_FRAMES * NUMBER_CEPS>;
+
+// Minimum class score (after dequantization) reported as a detection
+constexpr float kDetectionThreshold = 0.65f;
+
+// Variables for the classifier's output categories.
+constexpr int kCategoryCount = 7;
+constexpr const char* kCategoryLabels[kCategoryCount] = {
+    "go",
+    "no",
+    "off",
+    "on",
+    "stop",
+    "unknown",
+    "yes"
+};
+
+// Model input and output tensor quantization parameters
+struct QuantizationParams
+{
+    float input_scale;
+    int input_zero_point;
+    float output_scale;
+    int output_zero_point;
+};
+
+// Placeholder for builds without a model (linux target, host tools): unit input
+// scale, so quantization does the same work as with a real one
+constexpr QuantizationParams UNIT_QUANTIZATION = {1.0f, 0, 1.0f / 256, -128};
+
+// Derive the integer input quantization and output threshold from the model
+// tensor parameters (call once the tensors are allocated)
+void setup_quantization(const QuantizationParams& params);
+const QuantizationParams& get_quantization();
+void quantize_frame(const std::array<int16_t, NUMBER_CEPS>& coefficient, FeatureStore::Row& quantized);
+int detect_category(const int8_t* scores);
+float dequantize_score(int8_t score);
@@ -1,9 +1,28 @@
 #pragma once
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <atomic>
-#include "freertos/semphr.h"
+
+// Contiguous region of ring storage
+template<typename T>
+struct RingSpan
+{
+    T* data;
+    size_t size;
+};
+
+// Counters since start (peak_occupancy since the last reset_peak_occupancy())
+struct RingBufferStats
+{
+    uint32_t dropped_samples;    // Samples refused because the buffer was full
+    uint32_t overrun_events;     // Writes refused because the buffer was full
+    uint32_t peak_occupancy;     // Most samples waiting to be read
+    uint32_t starvation_events;  // Reader came back to a buffer still without a full frame
+};
 
 template<typename T, size_t BUFFER_SIZE, size_t SAMPLES_SIZE, size_t STRIDE>
 class RingBuffer
@@ -18,25 +37,54 @@ public:
     RingBuffer() : next_read(0), next_write(0) {};
     ~RingBuffer() {};
     
-    // Read SAMPLES_SIZE samples starting at next_read (with wrap-around)
-    // Returns true if successful, false if not enough data available
-    bool read_samples(T* dest) {
+    // Readable SAMPLES_SIZE region at next_read as up to two contiguous spans
+    // (the second one is empty unless the region wraps around). The samples
+    // stay valid until consume() releases them.
+    // Returns false if not enough data available
+    bool peek(RingSpan<const T>& first, RingSpan<const T>& second) {
         size_t current_read = next_read.load(std::memory_order_relaxed);
         size_t current_write = next_write.load(std::memory_order_acquire);
         
         // Check if we have enough samples available
         size_t available = (current_write - current_read) & (BUFFER_SIZE - 1);
         if (available < SAMPLES_SIZE) {
+            // The first miss ends a drain, a second one in a row means the reader starved
+            if (reader_waiting) {
+                starvation_events.fetch_add(1, std::memory_order_relaxed);
+            }
+            reader_waiting = true;
             return false; // Not enough data
         }
         
-        // Copy data (no lock needed - this data won't be overwritten)
-        for (size_t i = 0; i < SAMPLES_SIZE; i++) {
-            dest[i] = buffer[(current_read + i) & (BUFFER_SIZE - 1)];
+        reader_waiting = false;
+        
+        size_t until_end = BUFFER_SIZE - current_read;
+        first = {&buffer[current_read], SAMPLES_SIZE < until_end ? SAMPLES_SIZE : until_end};
+        second = {&buffer[0], SAMPLES_SIZE - first.size};
+        
+        return true;
+    }
+    
+    // Release the first size samples at next_read back to the writer
+    void consume(size_t size) {
+        size_t current_read = next_read.load(std::memory_order_relaxed);
+        next_read.store((current_read + size) & (BUFFER_SIZE - 1), std::memory_order_release);
+    }
+    
+    // Read SAMPLES_SIZE samples starting at next_read (with wrap-around)
+    // and advance by STRIDE. Returns true if successful, false if not enough data available
+    bool read_samples(T* dest) {
+        RingSpan<const T> first;
+        RingSpan<const T> second;
+        if (!peek(first, second)) {
+            return false; // Not enough data
         }
         
-        // Update read pointer atomically
-        next_read.store((current_read + STRIDE) & (BUFFER_SIZE - 1), std::memory_order_release);
+        // Copy data (no lock needed - this data won't be overwritten)
+        std::memcpy(dest, first.data, first.size * sizeof(T));
+        std::memcpy(dest + first.size, second.data, second.size * sizeof(T));
+        
+        consume(STRIDE);
         
         return true;
     }
@@ -44,26 +92,56 @@ public:
     // Write samples starting at next_write (with wrap-around)
     // Returns true if successful, false if buffer is full
     bool write_samples(const T* src, size_t size) {
-        size_t current_write = next_write.load(std::memory_order_relaxed);
-        size_t current_read = next_read.load(std::memory_order_acquire);
-        
-        // Check if we have enough space
-        size_t available_space = (current_read - current_write - 1) & (BUFFER_SIZE - 1);
-        if (available_space < size) {
+        RingSpan<T> first;
+        RingSpan<T> second;
+        if (!reserve_write(size, first, second)) {
             return false; // Buffer full - would overwrite unread data
         }
         
         // Copy data (no lock needed - reader won't access this yet)
-        for (size_t i = 0; i < size; i++) {
-            buffer[(current_write + i) & (BUFFER_SIZE - 1)] = src[i];
-        }
+        std::memcpy(first.data, src, first.size * sizeof(T));
+        std::memcpy(second.data, src + first.size, second.size * sizeof(T));
         
-        // Update write pointer atomically - makes data visible to reader
-        next_write.store((current_write + size) & (BUFFER_SIZE - 1), std::memory_order_release);
+        // Makes data visible to reader
+        commit_write(size);
         
         return true;
     }
     
+    // Reserve size samples at next_write as up to two contiguous spans (the
+    // second one is empty unless the region wraps around), to be filled in
+    // place and published with commit_write().
+    // Returns false if the buffer does not have room for size samples
+    bool reserve_write(size_t size, RingSpan<T>& first, RingSpan<T>& second) {
+        size_t current_write = next_write.load(std::memory_order_relaxed);
+        size_t current_read = next_read.load(std::memory_order_acquire);
+
+        size_t available_space = (current_read - current_write - 1) & (BUFFER_SIZE - 1);
+        if (available_space < size) {
+            overrun_events.fetch_add(1, std::memory_order_relaxed);
+            dropped_samples.fetch_add(size, std::memory_order_relaxed);
+            return false; // Buffer full - would overwrite unread data
+        }
+
+        size_t until_end = BUFFER_SIZE - current_write;
+        first = {&buffer[current_write], size < until_end ? size : until_end};
+        second = {&buffer[0], size - first.size};
+
+        return true;
+    }
+
+    // Publish size samples written into the spans from reserve_write()
+    void commit_write(size_t size) {
+        size_t current_write = next_write.load(std::memory_order_relaxed);
+        next_write.store((current_write + size) & (BUFFER_SIZE - 1), std::memory_order_release);
+
+        // Single writer: no other thread updates the peak
+        uint32_t occupancy = available();
+        if (occupancy > peak_occupancy.load(std::memory_order_relaxed)) {
+            peak_occupancy.store(occupancy, std::memory_order_relaxed);
+        }
+    }
+
     // Get SAMPLES_SIZE array from the buffer starting at next_read (with wrap-around)
     std::array<T, SAMPLES_SIZE> get_samples_as_array() {
         std::array<T, SAMPLES_SIZE> samples;
@@ -81,9 +159,35 @@ public:
         return (current_write - current_read) & (BUFFER_SIZE - 1);
     }
     
-    T buffer[BUFFER_SIZE]; // Public for DMA access
+    // Get number of samples that can be written
+    size_t free_space() {
+        size_t current_write = next_write.load(std::memory_order_relaxed);
+        size_t current_read = next_read.load(std::memory_order_acquire);
+        return (current_read - current_write - 1) & (BUFFER_SIZE - 1);
+    }
+    
+    // Snapshot of the counters, cheap enough to call from a periodic stats task
+    RingBufferStats stats() const {
+        return {
+            dropped_samples.load(std::memory_order_relaxed),
+            overrun_events.load(std::memory_order_relaxed),
+            peak_occupancy.load(std::memory_order_relaxed),
+            starvation_events.load(std::memory_order_relaxed),
+        };
+    }
+    
+    void reset_peak_occupancy() { peak_occupancy.store(0, std::memory_order_relaxed); }
+    
+    T buffer[BUFFER_SIZE]; // Public for DMA access, see reserve_write()
     
 private:
     std::atomic<size_t> next_read;
     std::atomic<size_t> next_write;
+    
+    // Statistics, updated by the writer (ISR) and the reader
+    std::atomic<uint32_t> dropped_samples{0};
+    std::atomic<uint32_t> overrun_events{0};
+    std::atomic<uint32_t> peak_occupancy{0};
+    std::atomic<uint32_t> starvation_events{0};
+    bool reader_waiting = false; // Reader side only
 };
\ No newline at end of file
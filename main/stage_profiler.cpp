@@ -0,0 +1,112 @@
+#include <cstdio>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "stage_profiler.hpp"
+#include "mfcc_constants.hpp"
+
+#ifdef KEWOKE_PROFILE
+
+CycleHistogram stage_cycles[size_t(ProfileStage::COUNT)];
+
+static const char* const STAGE_NAMES[size_t(ProfileStage::COUNT)] = {
+    "pre_emphasis",
+    "frame",
+    "window",
+    "fft",
+    "power_spectrum",
+    "mel_banks",
+    "dct",
+    "quantize",
+    "invoke",
+};
+
+// Reads that may spin before waiting for the writer: add_sample() takes a few
+// dozen cycles, unless its task was preempted inside it
+constexpr int MEAN_SPIN_ATTEMPTS = 16;
+
+uint32_t CycleHistogram::get_mean() const
+{
+    // Retry while the writer is inside add_sample(), or went through it meanwhile
+    for (int attempt = 0;; attempt++)
+    {
+        // A preempted writer of lower priority on this core only finishes
+        // while the reader is blocked (taskYIELD() would not let it run)
+        if (attempt >= MEAN_SPIN_ATTEMPTS)
+            vTaskDelay(1);
+
+        uint32_t sequence = total_sequence.load(std::memory_order_acquire);
+        uint32_t samples = count.load(std::memory_order_relaxed);
+        uint64_t sum = uint64_t(total_high.load(std::memory_order_relaxed)) << 32 |
+                       total_low.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!(sequence & 1) && total_sequence.load(std::memory_order_relaxed) == sequence)
+            return samples == 0 ? 0 : uint32_t(sum / samples);
+    }
+}
+
+uint32_t CycleHistogram::bucket_upper_bound(size_t bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return uint32_t(bucket);
+
+    int exponent = int(bucket / SUB_BUCKETS) + 1;
+    uint64_t width = uint64_t(1) << (exponent - 2);
+    uint64_t lower = (SUB_BUCKETS + bucket % SUB_BUCKETS) * width;
+    return uint32_t(lower + width - 1);
+}
+
+uint32_t CycleHistogram::get_percentile(uint32_t percent) const
+{
+    uint32_t samples = get_count();
+    if (samples == 0)
+        return 0;
+
+    // Smallest bucket with at least percent% of the samples at or below it
+    uint64_t rank = (uint64_t(samples) * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKETS; bucket++)
+    {
+        seen += buckets[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            uint32_t bound = bucket_upper_bound(bucket);
+            return bound < get_max() ? bound : get_max();
+        }
+    }
+    return get_max();
+}
+
+void profiler_dump(void)
+{
+    // Frame budget: one stride of audio at the nominal CPU frequency (DFS may run slower)
+    const uint64_t budget_cycles = uint64_t(FRAME_STRIDE) * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000 / SAMPLE_RATE;
+    // Pre-emphasis runs per ingested block, against the audio time of a DMA block
+    const uint64_t block_budget_cycles =
+        uint64_t(I2S_DMA_FRAME_SAMPLES) * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 1000000 / SAMPLE_RATE;
+
+    printf("Stage cycles (budget %llu cycles per %d ms stride at %d MHz)\n",
+           (unsigned long long)budget_cycles, FRAME_STRIDE * 1000 / SAMPLE_RATE, CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ);
+    printf("%-16s %8s %10s %10s %10s %10s %7s\n", "stage", "count", "min", "mean", "p99", "max", "mean%");
+
+    for (size_t stage = 0; stage < size_t(ProfileStage::COUNT); stage++)
+    {
+        const CycleHistogram& histogram = stage_cycles[stage];
+        uint32_t samples = histogram.get_count();
+        if (samples == 0)
+        {
+            printf("%-16s %8s\n", STAGE_NAMES[stage], "-");
+            continue;
+        }
+
+        uint32_t mean = histogram.get_mean();
+        uint64_t budget = stage == size_t(ProfileStage::PRE_EMPHASIS) ? block_budget_cycles : budget_cycles;
+        printf("%-16s %8lu %10lu %10lu %10lu %10lu %6.1f%%\n", STAGE_NAMES[stage], (unsigned long)samples,
+               (unsigned long)histogram.get_min(), (unsigned long)mean,
+               (unsigned long)histogram.get_percentile(99), (unsigned long)histogram.get_max(),
+               100.0 * mean / budget);
+    }
+}
+
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Profiled pipeline stages (KEWOKE_PROFILE builds)
+enum class ProfileStage : uint8_t
+{
+    PRE_EMPHASIS,   // One ingested audio block (I2S DMA completion ISR on the device)
+    FRAME,          // Whole front end for one frame
+    WINDOW,         // Hamming window and FFT input staging
+    FFT,
+    POWER_SPECTRUM,
+    MEL_BANKS,
+    DCT,
+    QUANTIZE,
+    INVOKE,         // Classifier
+    COUNT,
+};
+
+#ifdef KEWOKE_PROFILE
+#include "esp_cpu.h"
+
+// Cycle counts of one stage in fixed memory: count, min, mean, max and a
+// log-linear histogram (4 buckets per power of two) for percentiles.
+// Single writer (a task or the audio ISR), other tasks may read while it records.
+class CycleHistogram
+{
+public:
+    static constexpr int SUB_BUCKETS = 4;
+    static constexpr int BUCKETS = (32 - 1) * SUB_BUCKETS;
+
+    void record(uint32_t cycles)
+    {
+        size_t bucket = bucket_of(cycles);
+        buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (cycles < min.load(std::memory_order_relaxed))
+            min.store(cycles, std::memory_order_relaxed);
+        if (cycles > max.load(std::memory_order_relaxed))
+            max.store(cycles, std::memory_order_relaxed);
+        // Last, so a reader never sees more samples than buckets filled
+        add_sample(cycles);
+    }
+
+    uint32_t get_count() const { return count.load(std::memory_order_acquire); }
+    uint32_t get_min() const { return min.load(std::memory_order_relaxed); }
+    uint32_t get_max() const { return max.load(std::memory_order_relaxed); }
+    uint32_t get_mean() const;
+
+    // Upper bound of the bucket holding the given percentile (within 25%)
+    uint32_t get_percentile(uint32_t percent) const;
+
+private:
+    // Values below SUB_BUCKETS get a bucket each, then SUB_BUCKETS per power of two
+    static size_t bucket_of(uint32_t cycles)
+    {
+        if (cycles < SUB_BUCKETS)
+            return cycles;
+        int exponent = 31 - __builtin_clz(cycles);
+        uint32_t sub = (cycles >> (exponent - 2)) & (SUB_BUCKETS - 1);
+        return size_t(exponent - 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint32_t bucket_upper_bound(size_t bucket);
+
+    // 64-bit atomics are not lock-free on the ESP32 (libatomic takes a lock
+    // around each access, inside the FRAME scope), so the total is two 32-bit
+    // words behind a sequence count, odd while the writer updates them. The
+    // count goes in the same update so the mean divides matching values.
+    void add_sample(uint32_t cycles)
+    {
+        uint32_t sequence = total_sequence.load(std::memory_order_relaxed);
+        total_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        uint64_t sum = (uint64_t(total_high.load(std::memory_order_relaxed)) << 32 |
+                        total_low.load(std::memory_order_relaxed)) + cycles;
+        total_low.store(uint32_t(sum), std::memory_order_relaxed);
+        total_high.store(uint32_t(sum >> 32), std::memory_order_relaxed);
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        total_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> total_sequence{0};
+    std::atomic<uint32_t> total_low{0};
+    std::atomic<uint32_t> total_high{0};
+    std::atomic<uint32_t> min{UINT32_MAX};
+    std::atomic<uint32_t> max{0};
+    std::atomic<uint32_t> buckets[BUCKETS] = {};
+};
+
+// One histogram per stage, each written only by the task running the stage
+extern CycleHistogram stage_cycles[size_t(ProfileStage::COUNT)];
+
+// Print the stage table to the console
+void profiler_dump(void);
+
+// Cycles from construction to the end of the scope, added to the stage.
+// Counts whatever preempts the stage too (ISRs, higher priority tasks).
+class ProfileScope
+{
+public:
+    explicit ProfileScope(ProfileStage stage) : stage(stage), start(esp_cpu_get_cycle_count()) {}
+    ~ProfileScope() { stage_cycles[size_t(stage)].record(esp_cpu_get_cycle_count() - start); }
+
+private:
+    ProfileStage stage;
+    uint32_t start;
+};
+
+#define KEWOKE_PROFILE_CONCAT_(a, b) a##b
+#define KEWOKE_PROFILE_CONCAT(a, b) KEWOKE_PROFILE_CONCAT_(a, b)
+#define KEWOKE_PROFILE_SCOPE(stage) ProfileScope KEWOKE_PROFILE_CONCAT(profile_scope_, __LINE__)(stage)
+#else
+// Compiled out: no counter reads, no storage
+#define KEWOKE_PROFILE_SCOPE(stage)
+#endif
@@ -0,0 +1,80 @@
+#include <cstdio>
+#include <cstdlib>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "stats_console.h"
+#include "stage_profiler.hpp"
+
+#ifdef KEWOKE_PROFILE
+#include "esp_console.h"
+
+static const char* TAG = "stats_console";
+
+static void (*pipeline_dump)(void) = nullptr;
+
+// Every task's stack high-water mark, and its share of one core when run time stats are enabled
+static void dump_tasks(void)
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    UBaseType_t capacity = uxTaskGetNumberOfTasks() + 2; // Room for tasks created meanwhile
+    TaskStatus_t* tasks = static_cast<TaskStatus_t*>(malloc(capacity * sizeof(TaskStatus_t)));
+    if (tasks == nullptr)
+    {
+        printf("Task table: out of memory\n");
+        return;
+    }
+
+    uint32_t total_run_time = 0;
+    UBaseType_t count = uxTaskGetSystemState(tasks, capacity, &total_run_time);
+
+    printf("%-16s %4s %12s %7s\n", "task", "prio", "stack free", "cpu");
+    for (UBaseType_t i = 0; i < count; i++)
+    {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+        double cpu = total_run_time == 0 ? 0.0 : 100.0 * tasks[i].ulRunTimeCounter / total_run_time;
+        printf("%-16s %4lu %12lu %6.1f%%\n", tasks[i].pcTaskName, (unsigned long)tasks[i].uxCurrentPriority,
+               (unsigned long)tasks[i].usStackHighWaterMark, cpu);
+#else
+        printf("%-16s %4lu %12lu %7s\n", tasks[i].pcTaskName, (unsigned long)tasks[i].uxCurrentPriority,
+               (unsigned long)tasks[i].usStackHighWaterMark, "-");
+#endif
+    }
+    free(tasks);
+#else
+    printf("Task table needs CONFIG_FREERTOS_USE_TRACE_FACILITY (and CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS for cpu)\n");
+#endif
+}
+
+static int stats_command(int argc, char** argv)
+{
+    profiler_dump();
+    dump_tasks();
+    if (pipeline_dump != nullptr)
+        pipeline_dump();
+    return 0;
+}
+
+void stats_console_install(void (*dump_pipeline)(void))
+{
+    pipeline_dump = dump_pipeline;
+
+    esp_console_repl_t* repl = nullptr;
+    esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
+    repl_config.prompt = "kewoke>";
+    esp_console_dev_uart_config_t uart_config = ESP_CONSOLE_DEV_UART_CONFIG_DEFAULT();
+    ESP_ERROR_CHECK(esp_console_new_repl_uart(&uart_config, &repl_config, &repl));
+
+    esp_console_cmd_t command = {};
+    command.command = "stats";
+    command.help = "Stage cycle histograms, task run time and stacks, audio ring occupancy";
+    command.func = &stats_command;
+    ESP_ERROR_CHECK(esp_console_cmd_register(&command));
+
+    ESP_ERROR_CHECK(esp_console_start_repl(repl));
+    ESP_LOGI(TAG, "Type 'stats' on the console");
+}
+
+#endif
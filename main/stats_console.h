@@ -0,0 +1,6 @@
+#pragma once
+
+// `stats` command on the console UART (KEWOKE_PROFILE builds): stage cycle
+// histograms, FreeRTOS task run time and stack high-water marks, then
+// dump_pipeline() for the application's own counters (ring occupancy, ...)
+void stats_console_install(void (*dump_pipeline)(void));
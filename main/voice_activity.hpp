@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+
+constexpr int32_t VAD_THRESHOLD_Q8 = 530;      // ln(10^0.9) in Q8: 9 dB above the noise floor
+constexpr int VAD_FLOOR_FALL_SHIFT = 2;        // Floor follows quieter frames within a few frames
+constexpr int VAD_FLOOR_RISE_SHIFT = 9;        // and rises over ~10 s of louder ones
+
+// Energy voice activity detector on the frame energy (ln of the summed mel
+// energies, Q8, see MFCC::get_frame_energy()), compared with a noise floor that
+// drops quickly and creeps up slowly, so steady background noise is learnt
+// while speech bursts are not. A frame stays active for HANGOVER frames after
+// the last frame above the threshold.
+template <int HANGOVER>
+class VoiceActivityDetector
+{
+public:
+    // Update with one frame, returns true while activity (or its hangover) lasts
+    bool update(int32_t energy)
+    {
+        if (!initialized)
+        {
+            noise_floor_q16 = energy * 256;
+            initialized = true;
+        }
+
+        if (energy > get_noise_floor() + VAD_THRESHOLD_Q8)
+            frames_since_speech = 0;
+        else if (frames_since_speech <= HANGOVER)
+            frames_since_speech++;
+
+        // Extra 8 fractional bits so the slow rise does not round to zero
+        int32_t delta = energy * 256 - noise_floor_q16;
+        noise_floor_q16 += delta >> (delta < 0 ? VAD_FLOOR_FALL_SHIFT : VAD_FLOOR_RISE_SHIFT);
+
+        return active();
+    }
+
+    // Update with a frame below the silence threshold: not activity, and too
+    // quiet to say anything about the noise floor
+    bool update_silent()
+    {
+        if (frames_since_speech <= HANGOVER)
+            frames_since_speech++;
+        return active();
+    }
+
+    bool active() const { return frames_since_speech <= HANGOVER; }
+
+    // Noise floor, ln in Q8
+    int32_t get_noise_floor() const { return noise_floor_q16 >> 8; }
+    // False until the first update() sets the floor
+    bool has_noise_floor() const { return initialized; }
+
+private:
+    int32_t noise_floor_q16 = 0;
+    int frames_since_speech = HANGOVER + 1;
+    bool initialized = false;
+};
@@ -0,0 +1,51 @@
+#include <cstring>
+
+#include "mfcc_constants.hpp"
+#include "wav_file.hpp"
+
+// Little-endian field of a RIFF header
+static uint32_t read_le(const uint8_t* bytes, int size)
+{
+    uint32_t value = 0;
+    for (int i = size - 1; i >= 0; i--)
+        value = (value << 8) | bytes[i];
+    return value;
+}
+
+const char* parse_wav(const uint8_t* data, size_t size, PcmView& pcm)
+{
+    if (size < 12 || std::memcmp(data, "RIFF", 4) != 0 || std::memcmp(&data[8], "WAVE", 4) != 0)
+        return "not a RIFF/WAVE file";
+
+    bool format_ok = false;
+    size_t offset = 12;
+    while (offset + 8 <= size)
+    {
+        const uint8_t* chunk = &data[offset];
+        size_t chunk_size = read_le(chunk + 4, 4);
+        size_t body = offset + 8;
+        size_t available = chunk_size < size - body ? chunk_size : size - body;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && available >= 16)
+        {
+            uint32_t format = read_le(&data[body], 2);
+            uint32_t channels = read_le(&data[body + 2], 2);
+            uint32_t rate = read_le(&data[body + 4], 4);
+            uint32_t bits = read_le(&data[body + 14], 2);
+            if (format != 1 || channels != 1 || rate != uint32_t(SAMPLE_RATE) || bits != 16)
+                return "not 16 kHz mono 16-bit PCM";
+            format_ok = true;
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0 && format_ok)
+        {
+            // Chunks start on even offsets, so the samples are aligned
+            pcm.samples = reinterpret_cast<const int16_t*>(&data[body]);
+            pcm.count = available / sizeof(int16_t);
+            return nullptr;
+        }
+
+        offset = body + chunk_size + (chunk_size & 1);
+    }
+
+    return format_ok ? "no data chunk" : "no fmt chunk";
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Samples of a WAV file held in memory
+struct PcmView
+{
+    const int16_t* samples;
+    size_t count;
+};
+
+// Locate the samples of a SAMPLE_RATE mono 16-bit PCM WAV image (little-endian
+// targets only, the samples are used in place). Returns nullptr on success,
+// the reason the file was rejected otherwise
+const char* parse_wav(const uint8_t* data, size_t size, PcmView& pcm);
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Latest-wins triple buffer between one producer and one consumer task.
+// The producer always owns a free slot to fill, the consumer always gets the
+// newest complete window. A window replaced before the consumer picked it up
+// is dropped and counted.
+template<typename T>
+class WindowMailbox
+{
+public:
+    // Producer: slot to fill, owned by the producer until publish()
+    T& back() { return slots[back_index]; }
+
+    // Producer: make the filled slot the newest window
+    void publish()
+    {
+        uint8_t previous = middle.exchange(back_index | FRESH, std::memory_order_acq_rel);
+
+        // The consumer never saw the previous window
+        if (previous & FRESH)
+            dropped.fetch_add(1, std::memory_order_relaxed);
+
+        back_index = previous & INDEX_MASK;
+    }
+
+    // Consumer: newest window published since the last call, nullptr if none.
+    // The window stays owned by the consumer until the next call.
+    const T* receive()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return nullptr;
+
+        uint8_t previous = middle.exchange(front_index, std::memory_order_acq_rel);
+        front_index = previous & INDEX_MASK;
+        return &slots[front_index];
+    }
+
+    // Windows overwritten before the consumer received them
+    uint32_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    std::array<T, 3> slots{};
+    uint8_t back_index = 0;           // Producer side
+    std::atomic<uint8_t> middle{1};   // Shared, FRESH set until the consumer takes it
+    uint8_t front_index = 2;          // Consumer side
+    std::atomic<uint32_t> dropped{0};
+};
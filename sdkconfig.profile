@@ -0,0 +1,4 @@
+# sdkconfig defaults added by KEWOKE_PROFILE builds: task table with run time
+# per task for the `stats` console command
+CONFIG_FREERTOS_USE_TRACE_FACILITY=y
+CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS=y